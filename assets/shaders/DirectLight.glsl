@@ -0,0 +1,109 @@
+
+// Next-event estimation: the paths are connected to a point sampled on the emissive triangles with a shadow ray,
+// instead of waiting for a scattered ray to hit a light by chance. Both estimators are combined with multiple importance
+// sampling (power heuristic) at the diffuse surfaces, the only ones whose scattering is not (close to) a delta distribution.
+// Expects the includer to declare the Emitters buffer and to include a tracer (TraceRay.glsl or RayQuery.glsl).
+
+const float DirectLightPi = 3.1415926535897932384626433832795;
+
+float Luminance(const vec3 color)
+{
+	return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+float EmitterTotalPower()
+{
+	return Emitters[Emitters.length() - 1].PowerCdf;
+}
+
+// Solid angle density of the lambertian scattering (cosine weighted) toward the given direction.
+float LambertianPdf(const vec3 normal, const vec3 direction)
+{
+	return max(dot(normal, normalize(direction)), 0.0) / DirectLightPi;
+}
+
+// Solid angle density of the emitter sampling toward a light hit by a scattered ray.
+// The emitters are picked proportionally to their power then sampled uniformly, so that the area density is the same
+// on every emitter of a given radiance: pi * luminance / total power.
+float EmitterPdf(const vec3 emission, const vec3 lightNormal, const vec3 direction, const float lightDistance)
+{
+	const float totalPower = EmitterTotalPower();
+	const float cosine = abs(dot(lightNormal, normalize(direction)));
+
+	return totalPower > 0 && cosine > 0 ? DirectLightPi * Luminance(emission) / totalPower * lightDistance * lightDistance / cosine : 0.0;
+}
+
+float PowerHeuristic(const float pdf, const float otherPdf)
+{
+	return pdf * pdf / (pdf * pdf + otherPdf * otherPdf);
+}
+
+uint PickEmitter(inout uint seed)
+{
+	const uint count = uint(Emitters.length());
+	const float target = RandomFloat(seed) * EmitterTotalPower();
+
+	uint first = 0;
+	uint last = count - 1;
+
+	while (first < last)
+	{
+		const uint middle = (first + last) / 2;
+
+		if (Emitters[middle].PowerCdf <= target)
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+
+	return first;
+}
+
+// Direct light reflected by a lambertian surface of unit albedo toward the incoming ray (the caller applies the albedo),
+// weighted against the scattered rays that may hit the same light.
+vec3 DirectLight(const vec3 position, const vec3 normal, inout uint seed)
+{
+	const float totalPower = EmitterTotalPower();
+
+	if (totalPower <= 0)
+	{
+		return vec3(0);
+	}
+
+	const Emitter emitter = Emitters[PickEmitter(seed)];
+
+	// Uniform point on the triangle.
+	const float r0 = sqrt(RandomFloat(seed));
+	const float r1 = RandomFloat(seed);
+	const vec3 point = (1 - r0) * emitter.V0.xyz + r0 * (1 - r1) * emitter.V1.xyz + r0 * r1 * emitter.V2.xyz;
+	const vec3 lightNormal = normalize(cross(emitter.V1.xyz - emitter.V0.xyz, emitter.V2.xyz - emitter.V0.xyz));
+
+	const vec3 toLight = point - position;
+	const float lightDistance = length(toLight);
+	const vec3 direction = toLight / lightDistance;
+	const float cosine = dot(normal, direction);
+
+	// Like the lights hit by the scattered rays, the emitters are two sided.
+	const float lightPdf = EmitterPdf(emitter.EmissionAndArea.rgb, lightNormal, direction, lightDistance);
+
+	if (cosine <= 0 || lightPdf <= 0)
+	{
+		return vec3(0);
+	}
+
+	// Shadow ray.
+	const float tMin = 0.001;
+
+	if (IsOccluded(position, tMin, direction, lightDistance * 0.999 - tMin))
+	{
+		return vec3(0);
+	}
+
+	const float bsdfPdf = cosine / DirectLightPi;
+
+	return emitter.EmissionAndArea.rgb * (cosine / DirectLightPi) * PowerHeuristic(lightPdf, bsdfPdf) / lightPdf;
+}
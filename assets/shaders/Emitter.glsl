@@ -0,0 +1,11 @@
+
+// Emissive triangle of the scene (Assets::Emitter), sampled by the next-event estimation (see DirectLight.glsl).
+struct Emitter
+{
+	vec4 V0;
+	vec4 V1;
+	vec4 V2;
+	vec4 EmissionAndArea; // rgb = emitted radiance, w = triangle area
+	float Power;
+	float PowerCdf; // sum of the power of this emitter and all the ones before it
+};
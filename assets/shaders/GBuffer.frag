@@ -0,0 +1,53 @@
+#version 460
+#extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_include_directive : require
+#include "Material.glsl"
+#include "RayPayload.glsl"
+#include "UniformBufferObject.glsl"
+
+// Rasterised primary visibility: writes the same G-buffer as the probe-shaded raygen of RayTracing.rgen, with the surface
+// properties that RayTracing.rchit and Scatter.glsl would return for the primary hit.
+
+layout(binding = 0) readonly uniform UniformBufferObjectStruct { UniformBufferObject Camera; };
+layout(binding = 1) readonly buffer MaterialArray { Material[] Materials; };
+layout(binding = 2) uniform sampler2D[] TextureSamplers;
+
+layout(location = 0) in vec3 FragPosition;
+layout(location = 1) in vec3 FragNormal;
+layout(location = 2) in vec2 FragTexCoord;
+layout(location = 3) in flat int FragMaterialIndex;
+
+layout(location = 0) out float OutDepth;
+layout(location = 1) out vec4 OutNormal;
+layout(location = 2) out vec4 OutAlbedo;
+
+void main() 
+{
+	const Material m = Materials[FragMaterialIndex];
+	const vec3 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], FragTexCoord).rgb : vec3(1);
+
+	vec3 albedo = m.Diffuse.rgb * texColor;
+	float parameter = 0;
+
+	if (m.MaterialModel == MaterialMetallic)
+	{
+		parameter = m.Fuzziness;
+	}
+	else if (m.MaterialModel == MaterialDielectric)
+	{
+		albedo = texColor;
+		parameter = 1 / m.RefractionIndex;
+	}
+	else if (m.MaterialModel == MaterialDiffuseLight)
+	{
+		albedo = m.Diffuse.rgb;
+	}
+
+	// Distance along the (normalised) camera ray, from which the gather rebuilds the position.
+	const vec3 cameraPosition = (Camera.ModelViewInverse * vec4(0, 0, 0, 1)).xyz;
+
+	OutDepth = distance(FragPosition, cameraPosition);
+	OutNormal = vec4(normalize(FragNormal), PackSurfaceMaterial(m.MaterialModel, parameter));
+	OutAlbedo = vec4(albedo, 0);
+}
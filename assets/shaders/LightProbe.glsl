@@ -0,0 +1,298 @@
+
+// Octahedral mapping of the light probe directions, and addressing of the probe atlas.
+// Each probe occupies one layer of the atlas: its octahedral map is surrounded by a one texel gutter
+// that duplicates the opposite edge, so that bilinear filtering is seamless across the octahedral folds.
+
+const int ProbeGutter = 1;
+
+// Distance stored for the probe directions that do not hit any geometry.
+const float ProbeMaxDistance = 10000.0;
+
+// Fraction of the point to probe distance ignored by the visibility test, to avoid self-shadowing of the surfaces.
+const float ProbeDistanceBias = 0.05;
+
+float signNotZero(in float k) {
+    return (k >= 0.0) ? 1.0 : -1.0;
+}
+
+vec2 signNotZero(in vec2 v) {
+    return vec2(signNotZero(v.x), signNotZero(v.y));
+}
+
+vec3 mapToSphere(vec2 o) {
+
+
+    vec3 v = vec3(o.x, o.y, 1.0 - abs(o.x) - abs(o.y));
+    if (v.z < 0.0) {
+        v.xy = (1.0 - abs(v.yx)) * signNotZero(v.xy);
+    }
+    return normalize(v);
+}
+
+vec2 mapFromSphere(vec3 v) {
+
+    float l1norm = abs(v.x) + abs(v.y) + abs(v.z);
+    vec2 result = v.xy * (1.0 / l1norm);
+    if (v.z < 0.0) {
+        result = (1.0 - abs(result.yx)) * signNotZero(result.xy);
+    }
+    return result;
+}
+
+// Maps an octahedral coordinate in [0, 1] to the normalised coordinate of a probe atlas layer.
+vec2 ProbeAtlasUV(vec2 octUV, int resolution) {
+    return (octUV * resolution + ProbeGutter) / float(resolution + 2 * ProbeGutter);
+}
+
+// Regular grid of probes: probe (x, y, z) is at Origin + Spacing * (x, y, z), stored at index x + Count.x * (y + Count.y * z).
+struct LightProbeGridUniform
+{
+    vec4 Origin;
+    vec4 Spacing;
+    uvec4 Count; // xyz + total number of probes
+    ivec4 Scroll; // xyz = world grid coordinate of the first probe (see ProbeIndex), w = index of the first probe of the grid
+};
+
+// The probes are either a single grid fitted to the scene, or nested grids (cascades) centred on the camera, the finest first.
+const uint ProbeMaxCascades = 4;
+
+struct LightProbeCascadesUniform
+{
+    LightProbeGridUniform Grids[ProbeMaxCascades];
+    uvec4 CascadeCount;
+};
+
+// Slot of the probes whose data is not in the probe atlas (see LightProbeResidency).
+const uint ProbeNotResident = 0xFFFFFFFF;
+
+uint ProbeGridIndex(ivec3 probeCoord, uvec3 count) {
+    return uint(probeCoord.x) + count.x * (uint(probeCoord.y) + count.y * uint(probeCoord.z));
+}
+
+// Cascades scroll with the camera in whole probe steps. They use toroidal addressing: the probe at world grid coordinate c
+// is stored at slot c mod Count, so that the probes staying in the grid keep their slot (and their baked data) when it scrolls.
+ivec3 ProbeWrap(ivec3 coord, uvec3 count) {
+    const ivec3 n = ivec3(count);
+    return coord - n * ivec3(floor(vec3(coord) / vec3(n)));
+}
+
+// Index of the probe at the given coordinate of the grid, the grid coordinate (0, 0, 0) being its first probe.
+uint ProbeIndex(LightProbeGridUniform grid, ivec3 probeCoord) {
+    return uint(grid.Scroll.w) + ProbeGridIndex(ProbeWrap(probeCoord + grid.Scroll.xyz, grid.Count.xyz), grid.Count.xyz);
+}
+
+// Inverse of ProbeIndex, for a probe index of the grid.
+ivec3 ProbeCoord(LightProbeGridUniform grid, uint probeIndex) {
+    const uint slot = probeIndex - uint(grid.Scroll.w);
+    const uvec3 count = grid.Count.xyz;
+    const ivec3 slotCoord = ivec3(slot % count.x, (slot / count.x) % count.y, slot / (count.x * count.y));
+    return ProbeWrap(slotCoord - grid.Scroll.xyz, count);
+}
+
+// Offset of the shading point along the normal and towards the viewer, proportional to the probe spacing.
+vec3 ProbeSurfaceBias(vec3 normal, vec3 viewDirection, vec3 spacing) {
+    const float minSpacing = min(spacing.x, min(spacing.y, spacing.z));
+    return (normal * 0.2 - viewDirection * 0.8) * 0.3 * minSpacing;
+}
+
+// Chebyshev upper bound of the probability that a point at the given distance from the probe is visible from it,
+// given the mean and mean squared distance to the nearest geometry in that direction (as in variance shadow maps).
+float ProbeChebyshevVisibility(float dist, float meanDistance, float meanSquaredDistance) {
+
+    dist *= 1.0 - ProbeDistanceBias;
+
+    if (dist <= meanDistance) {
+        return 1.0;
+    }
+
+    const float variance = max(meanSquaredDistance - meanDistance * meanDistance, 1e-4 * meanDistance * meanDistance);
+    const float delta = dist - meanDistance;
+    const float chebyshev = variance / (variance + delta * delta);
+
+    // Sharpen the bound, it is very loose for occluders close to the probe.
+    return chebyshev * chebyshev * chebyshev;
+}
+
+// Blends new probe samples into the stored value. A zero hysteresis accumulates the running mean of the bake,
+// otherwise the new samples are blended in with an exponential moving average (dynamic probe updates).
+vec4 ProbeAccumulate(vec4 previous, vec4 sampleSum, uint sampleOffset, uint sampleCount, float hysteresis) {
+
+    if (hysteresis > 0.0) {
+        return mix(sampleSum / float(sampleCount), previous, hysteresis);
+    }
+
+    return (previous * float(sampleOffset) + sampleSum) / float(sampleOffset + sampleCount);
+}
+
+float ProbeLuminance(vec3 color) {
+    return dot(color, vec3(0.2126, 0.7152, 0.0722));
+}
+
+// Adaptive bake: a radiance texel (statistics = sample count, mean and mean squared luminance) has converged once the 95%
+// confidence interval of its mean luminance is narrower than threshold times the mean. Black texels converge as well.
+bool ProbeTexelConverged(vec4 statistics, float threshold, uint minSamples) {
+
+    const float sampleCount = statistics.x;
+
+    if (threshold <= 0.0 || sampleCount < float(max(minSamples, 2u))) {
+        return false;
+    }
+
+    const float mean = statistics.y;
+    const float variance = max(statistics.z - mean * mean, 0.0) * sampleCount / (sampleCount - 1.0);
+
+    return 1.96 * sqrt(variance / sampleCount) <= threshold * max(mean, 1e-4);
+}
+
+// Radiance texel encodings (LightProbeConfig::RadianceEncoding). The bake writes the radiance through an unsigned integer view
+// of the atlas and packs the linear HDR values itself, the shading samples the atlas in its actual format.
+const uint ProbeEncodingRGBA16F = 0;
+const uint ProbeEncodingRGBA32F = 1;
+const uint ProbeEncodingRGBA8 = 2;
+const uint ProbeEncodingB10G11R11 = 3;
+const uint ProbeEncodingE5B9G9R9 = 4;
+
+// Unsigned 11 and 10 bit floats are half floats without the sign bit and with a shorter mantissa (rounded to nearest).
+uint ProbePackUFloat(float value, uint mantissaBits) {
+    const uint halfBits = packHalf2x16(vec2(clamp(value, 0.0, 64512.0), 0)) & 0x7fffu;
+    const uint shift = 10u - mantissaBits;
+    return (halfBits + (1u << (shift - 1u))) >> shift;
+}
+
+float ProbeUnpackUFloat(uint value, uint mantissaBits) {
+    return unpackHalf2x16(value << (10u - mantissaBits)).x;
+}
+
+// Shared exponent encoding, as specified for VK_FORMAT_E5B9G9R9_UFLOAT_PACK32.
+uint ProbePackE5B9G9R9(vec3 rgb) {
+
+    const int mantissaBits = 9;
+    const int exponentBias = 15;
+    const float maxValue = float((1 << mantissaBits) - 1) / float(1 << mantissaBits) * exp2(float(31 - exponentBias));
+
+    const vec3 c = clamp(rgb, vec3(0), vec3(maxValue));
+    const float maxComponent = max(c.r, max(c.g, c.b));
+
+    int exponent = max(-exponentBias - 1, int(floor(log2(max(maxComponent, 1e-30))))) + 1 + exponentBias;
+    float scale = exp2(float(exponent - exponentBias - mantissaBits));
+
+    if (floor(maxComponent / scale + 0.5) == float(1 << mantissaBits)) {
+        scale *= 2.0;
+        exponent += 1;
+    }
+
+    const uvec3 mantissa = uvec3(floor(c / scale + 0.5));
+    return mantissa.r | (mantissa.g << 9) | (mantissa.b << 18) | (uint(exponent) << 27);
+}
+
+vec3 ProbeUnpackE5B9G9R9(uint value) {
+    const uvec3 mantissa = uvec3(value, value >> 9, value >> 18) & 0x1ffu;
+    return vec3(mantissa) * exp2(float(int(value >> 27) - 15 - 9));
+}
+
+uvec4 ProbeEncodeRadiance(vec3 radiance, uint encoding) {
+
+    switch (encoding) {
+    case ProbeEncodingRGBA32F: return floatBitsToUint(vec4(radiance, 0));
+    case ProbeEncodingRGBA8: return uvec4(packUnorm4x8(vec4(radiance, 0)), 0, 0, 0);
+    case ProbeEncodingB10G11R11: return uvec4(ProbePackUFloat(radiance.r, 6) | (ProbePackUFloat(radiance.g, 6) << 11) | (ProbePackUFloat(radiance.b, 5) << 22), 0, 0, 0);
+    case ProbeEncodingE5B9G9R9: return uvec4(ProbePackE5B9G9R9(radiance), 0, 0, 0);
+    default: return uvec4(packHalf2x16(radiance.rg), packHalf2x16(vec2(radiance.b, 0)), 0, 0);
+    }
+}
+
+vec3 ProbeDecodeRadiance(uvec4 texel, uint encoding) {
+
+    switch (encoding) {
+    case ProbeEncodingRGBA32F: return uintBitsToFloat(texel.rgb);
+    case ProbeEncodingRGBA8: return unpackUnorm4x8(texel.r).rgb;
+    case ProbeEncodingB10G11R11: return vec3(ProbeUnpackUFloat(texel.r & 0x7ffu, 6), ProbeUnpackUFloat((texel.r >> 11) & 0x7ffu, 6), ProbeUnpackUFloat(texel.r >> 22, 5));
+    case ProbeEncodingE5B9G9R9: return ProbeUnpackE5B9G9R9(texel.r);
+    default: return vec3(unpackHalf2x16(texel.r), unpackHalf2x16(texel.g).x);
+    }
+}
+
+// L2 spherical harmonics: 9 RGB coefficients per probe, stored as 27 tightly packed floats.
+const uint ProbeSHCoefficients = 9;
+const uint ProbeSHFloats = ProbeSHCoefficients * 3;
+
+void ProbeSHBasis(vec3 d, out float basis[ProbeSHCoefficients]) {
+
+    basis[0] = 0.282095;
+    basis[1] = 0.488603 * d.y;
+    basis[2] = 0.488603 * d.z;
+    basis[3] = 0.488603 * d.x;
+    basis[4] = 1.092548 * d.x * d.y;
+    basis[5] = 1.092548 * d.y * d.z;
+    basis[6] = 0.315392 * (3.0 * d.z * d.z - 1.0);
+    basis[7] = 1.092548 * d.x * d.z;
+    basis[8] = 0.546274 * (d.x * d.x - d.y * d.y);
+}
+
+// Irradiance around the given normal from the radiance SH coefficients, convolved with the clamped cosine lobe
+// (Ramamoorthi and Hanrahan, "An Efficient Representation for Irradiance Environment Maps").
+vec3 ProbeSHIrradiance(vec3 coefficients[ProbeSHCoefficients], vec3 normal) {
+
+    const float cosineLobe[3] = { 3.141593, 2.094395, 0.785398 };
+
+    float basis[ProbeSHCoefficients];
+    ProbeSHBasis(normal, basis);
+
+    vec3 irradiance = vec3(0);
+    for (uint i = 0; i < ProbeSHCoefficients; ++i) {
+        irradiance += cosineLobe[i == 0 ? 0 : (i < 4 ? 1 : 2)] * coefficients[i] * basis[i];
+    }
+
+    return max(irradiance, vec3(0));
+}
+
+// Glossy levels (LightProbeConfig::GlossyLevelOffset): level k is a map of resolution >> k with its own gutter,
+// the levels being laid out side by side in the probe layer.
+uint ProbeGlossyLevelOffset(uint resolution, uint level) {
+    return 2 * resolution - 2 * (resolution >> level) + 2 * level;
+}
+
+vec2 ProbeGlossyUV(vec2 octUV, uint resolution, uint level, vec2 layerSize) {
+    const uint levelResolution = resolution >> level;
+    return (octUV * levelResolution + ProbeGutter + vec2(ProbeGlossyLevelOffset(resolution, level), 0)) / layerSize;
+}
+
+// Angular spread (radians) of the reflections scattered by a metal of the given fuzziness (see ScatterMetallic):
+// the reflected direction is offset by a point in a sphere of that radius, whose standard deviation along an axis is radius / sqrt(5).
+float ProbeFuzzinessAngle(float fuzziness) {
+    return fuzziness * 0.447214;
+}
+
+// Relocation of the probes out of the geometry (see LightProbeRelocation.rgen). A probe that sees back faces in more than
+// this fraction of its rays is inside geometry, and a probe is kept at least this fraction of the spacing away from the front faces.
+const float ProbeRelocationBackfaceRatio = 0.25;
+const float ProbeRelocationFrontfaceDistance = 0.2;
+
+// Direction i out of n spread evenly over the sphere (spherical Fibonacci), turned around z by the given fraction of a turn.
+vec3 ProbeFibonacciDirection(uint i, uint n, float rotation) {
+    const float phi = 6.283185 * fract(float(i) * 0.618034 + rotation);
+    const float z = 1.0 - (2.0 * float(i) + 1.0) / float(n);
+    const float r = sqrt(max(1.0 - z * z, 0.0));
+    return vec3(r * cos(phi), r * sin(phi), z);
+}
+
+// Lists the gutter texels (in atlas layer coordinates) that duplicate the given octahedral map texel.
+int ProbeGutterTexels(ivec2 texel, int resolution, out ivec2 gutter[3]) {
+
+    const int last = resolution - 1;
+    int count = 0;
+
+    if (texel.x == 0) gutter[count++] = ivec2(-1, last - texel.y);
+    if (texel.x == last) gutter[count++] = ivec2(resolution, last - texel.y);
+    if (texel.y == 0) gutter[count++] = ivec2(last - texel.x, -1);
+    if (texel.y == last) gutter[count++] = ivec2(last - texel.x, resolution);
+
+    // Corners of the gutter are copied from the diagonally opposite corner of the map.
+    if (count == 2) gutter[count++] = ivec2(texel.x == 0 ? resolution : -1, texel.y == 0 ? resolution : -1);
+
+    for (int i = 0; i < count; ++i) {
+        gutter[i] += ProbeGutter;
+    }
+
+    return count;
+}
@@ -0,0 +1,197 @@
+
+// Light probe bake, shared by the bake raygen (LightProbe.rgen) and its inline ray query counterpart (LightProbeRayQuery.comp).
+// One invocation per radiance texel of a probe.
+// Expects the includer to declare the Camera, lightProbePos, atlas images, statistics and active texel resources, the
+// lightProbeCons push constants, the Ray payload, and to include a tracer and DirectLight.glsl.
+
+// Octahedral resolution of the probe maps.
+layout(constant_id = 0) const uint RadianceResolution = 64;
+layout(constant_id = 1) const uint DepthResolution = 16;
+
+// The bake bounce count is part of the bake configuration (and of the probe cache key), not of the camera settings.
+layout(constant_id = 2) const uint NumberOfBounces = 16;
+
+// Packing of the radiance texels (ProbeEncodeRadiance).
+layout(constant_id = 3) const uint RadianceEncoding = 0;
+
+// Adaptive bake: convergence test of the radiance texels (ProbeTexelConverged), 0 = every texel takes every sample.
+layout(constant_id = 4) const float AdaptiveThreshold = 0.0;
+layout(constant_id = 5) const uint AdaptiveMinSamples = 32;
+
+void BakeLightProbe(const uvec2 texel, const uint probe)
+{
+	vec3 pixelColor = vec3(0);
+	const vec4 lightProbe = lightProbePos[lightProbeCons.firstProbeIndex + probe];
+	const uint lightProbeIndex = uint(lightProbe.w);
+
+	const uint sampleOffset = lightProbeCons.sampleOffset;
+	const uint sampleCount = lightProbeCons.sampleCount;
+	const float hysteresis = lightProbeCons.hysteresis;
+	const bool hasPrevious = sampleOffset > 0 || hysteresis > 0;
+	Ray.RandomSeed = InitRandomSeed(InitRandomSeed(texel.x, texel.y), InitRandomSeed(lightProbeIndex, sampleOffset));
+
+	// During the bake, each radiance texel keeps its own sample count and stops sampling once converged.
+	// The updates blend a fixed number of samples into the baked radiance instead.
+	const bool isAdaptive = hysteresis == 0;
+	const uint statisticsIndex = (lightProbeIndex * RadianceResolution + texel.y) * RadianceResolution + texel.x;
+	const vec4 statistics = isAdaptive && sampleOffset > 0 ? lightProbeStatistics[statisticsIndex] : vec4(0);
+	const bool isConverged = isAdaptive && ProbeTexelConverged(statistics, AdaptiveThreshold, AdaptiveMinSamples);
+	const uint texelSampleOffset = isAdaptive ? uint(statistics.x) : sampleOffset;
+	const uint texelSampleCount = isConverged ? 0 : sampleCount;
+	float luminanceSum = 0;
+	float squaredLuminanceSum = 0;
+
+	for (uint s = 0; s < texelSampleCount; ++s)
+	{
+		
+		vec3 rayColor = vec3(0);
+		vec3 throughput = vec3(1);
+		float scatterPdf = 0; // density of the last scattered direction, 0 if it was not sampled from a diffuse surface
+		// Ray scatters are handled in this loop. There are no recursive traces in other shaders.
+		// Updates jitter the directions within the texel, so that successive updates do not resample the exact same rays.
+		const vec2 jitter = hysteresis > 0 ? vec2(RandomFloat(Ray.RandomSeed), RandomFloat(Ray.RandomSeed)) : vec2(0.5);
+		vec2 uv = (vec2(texel) + jitter) / float(RadianceResolution) * 2.0 - 1.0;
+		vec4 direction = vec4(mapToSphere(uv),0);
+		vec4 origin = vec4(lightProbe.xyz, 1);
+
+		for (uint b = 0; b  <= NumberOfBounces; ++b)
+		{
+	
+			const float tMin = 0.001;
+			const float tMax = 10000.0;
+
+			// If we've exceeded the ray bounce limit, no more light is gathered.
+			// Light emitting materials never scatter in this implementation, allowing us to make this logical shortcut.
+			if (b == NumberOfBounces) 
+			{
+				break;
+			}
+
+			Trace(origin.xyz, tMin, direction.xyz, tMax);
+			
+			// The shadow rays reuse the payload.
+			const vec3 emission = Ray.ColorAndDistance.rgb;
+			const float t = Ray.ColorAndDistance.w;
+			const bool isScattered = Ray.ScatterDirection.w > 0;
+			const vec4 scatterDirection = Ray.ScatterDirection;
+			const vec4 surface = Ray.normal;
+
+			//Capture in-direct light information
+			const vec3 hitColor = b > 0 ? emission : vec3(1);
+
+			// Trace missed, or end of trace.
+			if (t < 0 || !isScattered)
+			{
+				// Lights also sampled by the next-event estimation of the previous bounce are weighted against it.
+				const bool isSampledLight = t >= 0 && SurfaceMaterialModel(surface) == MaterialDiffuseLight && scatterDirection.x > 0;
+				const float lightPdf = isSampledLight && scatterPdf > 0 ? EmitterPdf(emission, surface.xyz, direction.xyz, t * length(direction.xyz)) : 0.0;
+				const float weight = lightPdf > 0 ? PowerHeuristic(scatterPdf, lightPdf) : 1.0;
+
+				rayColor += throughput * hitColor * weight;
+				break;
+			}
+
+			throughput *= hitColor;
+
+			// Trace hit.
+			origin = origin + t * direction;
+			direction = vec4(scatterDirection.xyz, 0);
+
+			// Direct light at the diffuse surfaces.
+			if (SurfaceMaterialModel(surface) == MaterialLambertian)
+			{
+				rayColor += throughput * DirectLight(origin.xyz, surface.xyz, Ray.RandomSeed);
+				scatterPdf = LambertianPdf(surface.xyz, direction.xyz);
+			}
+			else
+			{
+				scatterPdf = 0;
+			}
+		}
+
+		const float luminance = ProbeLuminance(rayColor);
+		luminanceSum += luminance;
+		squaredLuminanceSum += luminance * luminance;
+		pixelColor += rayColor;
+	}
+
+	// Border texels are duplicated into the gutter of the atlas layer.
+	ivec2 gutter[3];
+
+	// Converged texels keep their radiance as is.
+	if (!isConverged)
+	{
+		// Progressive running mean of the linear radiance, gamma is applied when the probe is sampled.
+		const ivec3 atlasTexel = ivec3(ivec2(texel) + ProbeGutter, lightProbeIndex);
+		const vec3 previousColor = texelSampleOffset > 0 || hysteresis > 0 ? ProbeDecodeRadiance(imageLoad(radianceOutputTexture, atlasTexel), RadianceEncoding) : vec3(0);
+		pixelColor = ProbeAccumulate(vec4(previousColor, 0), vec4(pixelColor, 0), texelSampleOffset, sampleCount, hysteresis).rgb;
+		const uvec4 encodedColor = ProbeEncodeRadiance(pixelColor, RadianceEncoding);
+		imageStore(radianceOutputTexture, atlasTexel, encodedColor);
+
+		const int gutterCount = ProbeGutterTexels(ivec2(texel), int(RadianceResolution), gutter);
+
+		for (int i = 0; i < gutterCount; ++i)
+		{
+			imageStore(radianceOutputTexture, ivec3(gutter[i], lightProbeIndex), encodedColor);
+		}
+	}
+
+	if (isAdaptive && !isConverged)
+	{
+		const vec2 moments = ProbeAccumulate(vec4(statistics.yz, 0, 0), vec4(luminanceSum, squaredLuminanceSum, 0, 0), texelSampleOffset, sampleCount, 0).xy;
+		const vec4 newStatistics = vec4(float(texelSampleOffset + sampleCount), moments, 0);
+		lightProbeStatistics[statisticsIndex] = newStatistics;
+
+		if (!ProbeTexelConverged(newStatistics, AdaptiveThreshold, AdaptiveMinSamples))
+		{
+			atomicAdd(lightProbeActiveTexels, 1);
+		}
+	}
+
+	// Mean and mean squared distance to the nearest geometry, at the depth map resolution.
+	// The launch grid is the radiance one, so each invocation handles every RadianceResolution^2-th depth texel.
+	const uint launchIndex = texel.y * RadianceResolution + texel.x;
+
+	for (uint d = launchIndex; d < DepthResolution * DepthResolution; d += RadianceResolution * RadianceResolution)
+	{
+		const ivec2 depthTexel = ivec2(d % DepthResolution, d / DepthResolution);
+		const vec4 origin = vec4(lightProbe.xyz, 1);
+
+		float distanceSum = 0;
+		float squaredDistanceSum = 0;
+
+		for (uint s = 0; s < sampleCount; ++s)
+		{
+			// Jitter the direction within the texel footprint, so that the moments capture the depth variations it covers.
+			const vec2 jitter = vec2(RandomFloat(Ray.RandomSeed), RandomFloat(Ray.RandomSeed));
+			const vec2 uv = (vec2(depthTexel) + jitter) / float(DepthResolution) * 2.0 - 1.0;
+			const vec3 direction = mapToSphere(uv);
+
+			Trace(origin.xyz, 0.001, direction, ProbeMaxDistance);
+
+			const float t = Ray.ColorAndDistance.w < 0 ? ProbeMaxDistance : Ray.ColorAndDistance.w;
+
+			distanceSum += t;
+			squaredDistanceSum += t * t;
+		}
+
+		const ivec3 depthTexelLayer = ivec3(depthTexel + ProbeGutter, lightProbeIndex);
+		const vec2 previousMoments = hasPrevious
+			? vec2(imageLoad(sphericalDistanceTexture, depthTexelLayer).r, imageLoad(squaredDistanceTexture, depthTexelLayer).r)
+			: vec2(0);
+		const vec2 moments = ProbeAccumulate(vec4(previousMoments, 0, 0), vec4(distanceSum, squaredDistanceSum, 0, 0), sampleOffset, sampleCount, hysteresis).xy;
+		const float meanDistance = moments.x;
+		const float meanSquaredDistance = moments.y;
+
+		imageStore(sphericalDistanceTexture, depthTexelLayer, vec4(meanDistance));
+		imageStore(squaredDistanceTexture, depthTexelLayer, vec4(meanSquaredDistance));
+
+		const int depthGutterCount = ProbeGutterTexels(depthTexel, int(DepthResolution), gutter);
+
+		for (int i = 0; i < depthGutterCount; ++i)
+		{
+			imageStore(sphericalDistanceTexture, ivec3(gutter[i], lightProbeIndex), vec4(meanDistance));
+			imageStore(squaredDistanceTexture, ivec3(gutter[i], lightProbeIndex), vec4(meanSquaredDistance));
+		}
+	}
+}
@@ -59,3 +59,12 @@ vec3 RandomInUnitSphere(inout uint seed)
 		}
 	}
 }
+
+vec3 RandomUnitVector(inout uint seed)
+{
+	const float z = 2 * RandomFloat(seed) - 1;
+	const float phi = 6.283185307179586 * RandomFloat(seed);
+	const float r = sqrt(max(1 - z * z, 0.0));
+
+	return vec3(r * cos(phi), r * sin(phi), z);
+}
@@ -3,6 +3,23 @@ struct RayPayload
 {
 	vec4 ColorAndDistance; // rgb + t
 	vec4 ScatterDirection; // xyz + w (is scatter needed)
-	vec4 normal;
+	vec4 normal; // xyz + w (material model and parameter, see PackSurfaceMaterial)
 	uint RandomSeed;
 };
+
+// The probe shading needs to know how the hit surface reflects light. The material model and its parameter in [0, 1]
+// (the fuzziness of metals, the inverse refraction index of dielectrics) are packed in the normal w component.
+float PackSurfaceMaterial(uint materialModel, float parameter)
+{
+	return float(materialModel) * 2.0 + clamp(parameter, 0.0, 1.0);
+}
+
+uint SurfaceMaterialModel(vec4 normal)
+{
+	return uint(normal.w * 0.5);
+}
+
+float SurfaceMaterialParameter(vec4 normal)
+{
+	return normal.w - float(SurfaceMaterialModel(normal)) * 2.0;
+}
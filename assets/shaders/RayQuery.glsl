@@ -0,0 +1,152 @@
+#extension GL_EXT_ray_query : require
+
+#include "Scatter.glsl"
+#include "Vertex.glsl"
+
+// Inline ray query backend of the tracer, same interface as TraceRay.glsl. The work of the intersection, closest hit and
+// miss shaders (RayTracing.Procedural.rint, RayTracing.rchit, RayTracing.Procedural.rchit, RayTracing.rmiss) is done in
+// place, from the scene buffers.
+// Expects the includer to declare the Scene acceleration structure, the Camera uniform buffer and the Vertices, Indices,
+// Materials, Offsets, TextureSamplers and Spheres buffers.
+
+// There is no payload with ray queries, the traces fill this global instead.
+RayPayload Ray;
+
+const float RayQueryPi = 3.1415926535897932384626433832795;
+
+vec2 RayQueryMix(vec2 a, vec2 b, vec2 c, vec3 barycentrics)
+{
+	return a * barycentrics.x + b * barycentrics.y + c * barycentrics.z;
+}
+
+vec3 RayQueryMix(vec3 a, vec3 b, vec3 c, vec3 barycentrics)
+{
+	return a * barycentrics.x + b * barycentrics.y + c * barycentrics.z;
+}
+
+vec2 GetSphereTexCoord(const vec3 point)
+{
+	const float phi = atan(point.x, point.z);
+	const float theta = asin(point.y);
+
+	return vec2
+	(
+		(phi + RayQueryPi) / (2 * RayQueryPi),
+		1 - (theta + RayQueryPi / 2) / RayQueryPi
+	);
+}
+
+// Closest intersection of the ray with the sphere in [tMin, tMax), see RayTracing.Procedural.rint.
+bool IntersectSphere(const vec4 sphere, const vec3 origin, const vec3 direction, const float tMin, const float tMax, out float t)
+{
+	const vec3 center = sphere.xyz;
+	const float radius = sphere.w;
+
+	const vec3 oc = origin - center;
+	const float a = dot(direction, direction);
+	const float b = dot(oc, direction);
+	const float c = dot(oc, oc) - radius * radius;
+	const float discriminant = b * b - a * c;
+
+	if (discriminant < 0)
+	{
+		return false;
+	}
+
+	const float t1 = (-b - sqrt(discriminant)) / a;
+	const float t2 = (-b + sqrt(discriminant)) / a;
+
+	t = (tMin <= t1 && t1 < tMax) ? t1 : t2;
+
+	return tMin <= t && t < tMax;
+}
+
+// Traversal of the acceleration structure. The opaque triangles are committed by the traversal itself, only the
+// procedural spheres come back as candidates. A macro rather than a function, ray queries cannot be passed around.
+#define RAY_QUERY_TRAVERSE(rayQuery, origin, tMin, direction, tMax) \
+	while (rayQueryProceedEXT(rayQuery)) \
+	{ \
+		if (rayQueryGetIntersectionTypeEXT(rayQuery, false) == gl_RayQueryCandidateIntersectionAABBEXT) \
+		{ \
+			const bool hasClosest = rayQueryGetIntersectionTypeEXT(rayQuery, true) != gl_RayQueryCommittedIntersectionNoneEXT; \
+			const float closestT = hasClosest ? rayQueryGetIntersectionTEXT(rayQuery, true) : tMax; \
+			float sphereT; \
+			if (IntersectSphere(Spheres[rayQueryGetIntersectionInstanceCustomIndexEXT(rayQuery, false)], origin, direction, tMin, closestT, sphereT)) \
+			{ \
+				rayQueryGenerateIntersectionEXT(rayQuery, sphereT); \
+			} \
+		} \
+	}
+
+void Trace(const vec3 origin, const float tMin, const vec3 direction, const float tMax)
+{
+	rayQueryEXT rayQuery;
+	rayQueryInitializeEXT(rayQuery, Scene, gl_RayFlagsOpaqueEXT, 0xff, origin, tMin, direction, tMax);
+
+	RAY_QUERY_TRAVERSE(rayQuery, origin, tMin, direction, tMax)
+
+	const uint hitType = rayQueryGetIntersectionTypeEXT(rayQuery, true);
+
+	// Miss: sky color.
+	if (hitType == gl_RayQueryCommittedIntersectionNoneEXT)
+	{
+		const float t = 0.5 * (normalize(direction).y + 1);
+		const vec3 skyColor = mix(vec3(1.0), vec3(0.5, 0.7, 1.0), t);
+
+		Ray.ColorAndDistance = Camera.HasSky ? vec4(skyColor, -1) : vec4(0, 0, 0, -1);
+		return;
+	}
+
+	// Get the material.
+	const uint instance = rayQueryGetIntersectionInstanceCustomIndexEXT(rayQuery, true);
+	const float t = rayQueryGetIntersectionTEXT(rayQuery, true);
+	const uvec2 offsets = Offsets[instance];
+	const uint indexOffset = offsets.x;
+	const uint vertexOffset = offsets.y;
+
+	if (hitType == gl_RayQueryCommittedIntersectionTriangleEXT)
+	{
+		const uint primitive = rayQueryGetIntersectionPrimitiveIndexEXT(rayQuery, true);
+		const Vertex v0 = UnpackVertex(vertexOffset + Indices[indexOffset + primitive * 3 + 0]);
+		const Vertex v1 = UnpackVertex(vertexOffset + Indices[indexOffset + primitive * 3 + 1]);
+		const Vertex v2 = UnpackVertex(vertexOffset + Indices[indexOffset + primitive * 3 + 2]);
+		const Material material = Materials[v0.MaterialIndex];
+
+		// Compute the ray hit point properties.
+		const vec2 hitAttributes = rayQueryGetIntersectionBarycentricsEXT(rayQuery, true);
+		const vec3 barycentrics = vec3(1.0 - hitAttributes.x - hitAttributes.y, hitAttributes.x, hitAttributes.y);
+		const vec3 normal = normalize(RayQueryMix(v0.Normal, v1.Normal, v2.Normal, barycentrics));
+		const vec2 texCoord = RayQueryMix(v0.TexCoord, v1.TexCoord, v2.TexCoord, barycentrics);
+
+		Ray = Scatter(material, direction, normal, texCoord, t, Ray.RandomSeed);
+	}
+	else
+	{
+		const Vertex v0 = UnpackVertex(vertexOffset + Indices[indexOffset]);
+		const Material material = Materials[v0.MaterialIndex];
+
+		// Compute the ray hit point properties.
+		const vec4 sphere = Spheres[instance];
+		const vec3 point = origin + t * direction;
+		const vec3 normal = (point - sphere.xyz) / sphere.w;
+		const vec2 texCoord = GetSphereTexCoord(normal);
+
+		Ray = Scatter(material, direction, normal, texCoord, t, Ray.RandomSeed);
+
+		// Procedural spheres are not in the emitter list, only the scattered rays can find their light.
+		if (material.MaterialModel == MaterialDiffuseLight)
+		{
+			Ray.ScatterDirection.x = 0;
+		}
+	}
+}
+
+bool IsOccluded(const vec3 origin, const float tMin, const vec3 direction, const float tMax)
+{
+	rayQueryEXT rayQuery;
+	rayQueryInitializeEXT(rayQuery, Scene, gl_RayFlagsOpaqueEXT | gl_RayFlagsTerminateOnFirstHitEXT, 0xff, origin, tMin, direction, tMax);
+
+	RAY_QUERY_TRAVERSE(rayQuery, origin, tMin, direction, tMax)
+
+	return rayQueryGetIntersectionTypeEXT(rayQuery, true) != gl_RayQueryCommittedIntersectionNoneEXT;
+}
@@ -0,0 +1,271 @@
+
+// The render modes of the main pass, shared by the raygen (RayTracing.rgen) and its inline ray query counterpart (RayQuery.comp).
+// Expects the includer to declare the AccumulationImage, OutputImage, G-buffer images, history images, Camera,
+// radianceProbeTexture, lightProbeSlot and lightProbeCons resources, the Ray payload, and to include a tracer and
+// DirectLight.glsl.
+
+// Each render mode is its own raygen record of the shader binding table (its own compute pipeline with ray queries),
+// so that a mode does not carry the registers and stack of the others (RenderMode in RayTracingPipeline.hpp).
+layout(constant_id = 0) const uint RenderMode = 0;
+
+const uint RenderModePathTraced = 0;
+const uint RenderModeProbeShaded = 1;
+const uint RenderModeProbeTexture = 2;
+
+// Temporal accumulation: instead of starting over when the camera moves, the accumulation of the previous frame
+// (HistoryImage: average color and number of samples) is reprojected through the primary hit of the pixel. History taps
+// whose hit distance or normal (HistoryDepth, HistoryNormal) disagree with the reprojected hit were occluded, they are
+// rejected. The history weight is clamped while moving, so that the resampled history fades out.
+// Writes the primary hit distance and normal of the pixel to the G-buffer (the next frame's history), returns the new
+// average color and number of samples.
+vec4 TemporalAccumulate(const uvec2 launchId, const uvec2 launchSize, const vec3 colorSum, const vec2 primaryPixel, const vec4 primaryHit, const vec3 primaryNormal)
+{
+	const ivec2 pixel = ivec2(launchId);
+
+	// Static camera whose sample budget is spent, nothing was traced.
+	if (Camera.NumberOfSamples == 0)
+	{
+		imageStore(GBufferDepth, pixel, imageLoad(HistoryDepth, pixel));
+		imageStore(GBufferNormal, pixel, imageLoad(HistoryNormal, pixel));
+		return imageLoad(HistoryImage, pixel);
+	}
+
+	const bool isHit = primaryHit.w > 0;
+	const vec3 cameraPosition = (Camera.ModelViewInverse * vec4(0, 0, 0, 1)).xyz;
+
+	imageStore(GBufferDepth, pixel, vec4(isHit ? distance(primaryHit.xyz, cameraPosition) : -1));
+	imageStore(GBufferNormal, pixel, vec4(primaryNormal, 0));
+
+	// First frame after a reset.
+	if (Camera.NumberOfSamples == Camera.TotalNumberOfSamples)
+	{
+		return vec4(colorSum / Camera.NumberOfSamples, Camera.NumberOfSamples);
+	}
+
+	// Position of the pixel in the previous frame, from the motion of its primary hit (of its direction if missed).
+	const vec4 previousView = Camera.PreviousModelView * vec4(primaryHit.xyz, isHit ? 1 : 0);
+	const vec4 previousClip = Camera.Projection * previousView;
+	vec2 motion = ((previousClip.xy / previousClip.w) * 0.5 + 0.5) * launchSize - primaryPixel;
+
+	// Below a hundredth of a pixel, the motion is the numerical noise of a static camera, resampling would blur the history.
+	const bool isMoving = dot(motion, motion) > 1e-4;
+	motion = isMoving ? motion : vec2(0);
+
+	const vec2 position = vec2(pixel) + motion;
+	const ivec2 base = ivec2(floor(position));
+	const vec2 f = position - vec2(base);
+	const float previousDistance = length(previousView.xyz);
+
+	// Bilinear history, from the taps that saw the same surface.
+	vec4 history = vec4(0);
+	float weightSum = 0;
+
+	for (int i = 0; i != 4; ++i)
+	{
+		const ivec2 offset = ivec2(i & 1, i >> 1);
+		const ivec2 tap = base + offset;
+		const vec2 bilinear = mix(1 - f, f, vec2(offset));
+		const float weight = bilinear.x * bilinear.y;
+
+		if (weight == 0 || previousClip.w <= 0 || any(lessThan(tap, ivec2(0))) || any(greaterThanEqual(tap, ivec2(launchSize))))
+		{
+			continue;
+		}
+
+		const float historyDistance = imageLoad(HistoryDepth, tap).r;
+		const vec3 historyNormal = imageLoad(HistoryNormal, tap).xyz;
+		const bool isSameSurface = isHit
+			? historyDistance >= 0 && abs(historyDistance - previousDistance) <= 0.05 * previousDistance && dot(historyNormal, primaryNormal) > 0.9
+			: historyDistance < 0;
+
+		if (isSameSurface)
+		{
+			history += weight * imageLoad(HistoryImage, tap);
+			weightSum += weight;
+		}
+	}
+
+	// Disoccluded pixels start over from the samples of this frame.
+	const vec4 historyAverage = weightSum > 0 ? history / weightSum : vec4(0);
+	const float historySamples = isMoving ? min(historyAverage.a, float(Camera.TemporalMaxHistory)) : historyAverage.a;
+	const float sampleCount = historySamples + Camera.NumberOfSamples;
+
+	return vec4((historyAverage.rgb * historySamples + colorSum) / sampleCount, sampleCount);
+}
+
+void PathTrace(const uvec2 launchId, const uvec2 launchSize)
+{
+	const uint64_t clock = Camera.ShowHeatmap ? clockARB() : 0;
+
+	// Initialise separate random seeds for the pixel and the rays.
+	// - pixel: we want the same random seed for each pixel to get a homogeneous anti-aliasing.
+	// - ray: we want a noisy random seed, different for each pixel.
+	uint pixelRandomSeed = Camera.RandomSeed;
+	Ray.RandomSeed = InitRandomSeed(InitRandomSeed(launchId.x, launchId.y), Camera.TotalNumberOfSamples);
+
+	vec3 pixelColor = vec3(0);
+
+	// Primary hit of the first sample, for the temporal accumulation: its subpixel position, the hit point (the ray
+	// direction and a negative w if missed) and the surface normal.
+	vec2 primaryPixel = vec2(launchId);
+	vec4 primaryHit = vec4(0, 0, 0, -1);
+	vec3 primaryNormal = vec3(0);
+
+	// Accumulate all the rays for this pixels.
+	for (uint s = 0; s < Camera.NumberOfSamples; ++s)
+	{
+		//if (Camera.NumberOfSamples != Camera.TotalNumberOfSamples) break;
+		const vec2 pixel = vec2(launchId.x + RandomFloat(pixelRandomSeed), launchId.y + RandomFloat(pixelRandomSeed));
+		const vec2 uv = (pixel / launchSize) * 2.0 - 1.0;
+
+		vec2 offset = Camera.Aperture/2 * RandomInUnitDisk(Ray.RandomSeed);
+		vec4 origin = Camera.ModelViewInverse * vec4(offset, 0, 1);
+		vec4 target = Camera.ProjectionInverse * (vec4(uv.x, uv.y, 1, 1));
+		vec4 direction = Camera.ModelViewInverse * vec4(normalize(target.xyz * Camera.FocusDistance - vec3(offset, 0)), 0);
+		vec3 rayColor = vec3(0);
+		vec3 throughput = vec3(1);
+		float scatterPdf = 0; // density of the last scattered direction, 0 if it was not sampled from a diffuse surface
+
+		// Ray scatters are handled in this loop. There are no recursive traces in other shaders.
+		for (uint b = 0; b <= Camera.NumberOfBounces; ++b)
+		{
+			const float tMin = 0.001;
+			const float tMax = 10000.0;
+
+			// If we've exceeded the ray bounce limit, no more light is gathered.
+			// Light emitting materials never scatter in this implementation, allowing us to make this logical shortcut.
+			if (b == Camera.NumberOfBounces) 
+			{
+				break;
+			}
+
+			Trace(origin.xyz, tMin, direction.xyz, tMax);
+			
+			// The shadow rays reuse the payload.
+			const vec3 hitColor = Ray.ColorAndDistance.rgb;
+			const float t = Ray.ColorAndDistance.w;
+			const bool isScattered = Ray.ScatterDirection.w > 0;
+			const vec4 scatterDirection = Ray.ScatterDirection;
+			const vec4 surface = Ray.normal;
+
+			if (Camera.TemporalAccumulation && s == 0 && b == 0)
+			{
+				primaryPixel = pixel;
+				primaryHit = t < 0 ? vec4(direction.xyz, -1) : vec4(origin.xyz + t * direction.xyz, 1);
+				primaryNormal = surface.xyz;
+			}
+
+			// Trace missed, or end of trace.
+			if (t < 0 || !isScattered)
+			{	
+				// Lights also sampled by the next-event estimation of the previous bounce are weighted against it.
+				const bool isSampledLight = t >= 0 && SurfaceMaterialModel(surface) == MaterialDiffuseLight && scatterDirection.x > 0;
+				const float lightPdf = isSampledLight && scatterPdf > 0 ? EmitterPdf(hitColor, surface.xyz, direction.xyz, t * length(direction.xyz)) : 0.0;
+				const float weight = lightPdf > 0 ? PowerHeuristic(scatterPdf, lightPdf) : 1.0;
+
+				rayColor += throughput * hitColor * weight;
+				break;
+			}
+
+			throughput *= hitColor;
+
+			// Trace hit.
+			origin = origin + t * direction;
+			direction = vec4(scatterDirection.xyz, 0);
+
+			// Direct light at the diffuse surfaces.
+			if (SurfaceMaterialModel(surface) == MaterialLambertian)
+			{
+				rayColor += throughput * DirectLight(origin.xyz, surface.xyz, Ray.RandomSeed);
+				scatterPdf = LambertianPdf(surface.xyz, direction.xyz);
+			}
+			else
+			{
+				scatterPdf = 0;
+			}
+		}
+
+		pixelColor += rayColor;
+	}
+
+	// Color sum and no sample count, or average color and sample count with temporal accumulation.
+	vec4 accumulation;
+
+	if (Camera.TemporalAccumulation)
+	{
+		accumulation = TemporalAccumulate(launchId, launchSize, pixelColor, primaryPixel, primaryHit, primaryNormal);
+		pixelColor = accumulation.rgb;
+	}
+	else
+	{
+		const bool accumulate = Camera.NumberOfSamples != Camera.TotalNumberOfSamples;
+		accumulation = vec4((accumulate ? imageLoad(AccumulationImage, ivec2(launchId)) : vec4(0)).rgb + pixelColor, 0);
+		pixelColor = accumulation.rgb / Camera.TotalNumberOfSamples;
+	}
+
+	// Apply raytracing-in-one-weekend gamma correction.
+	pixelColor = sqrt(pixelColor);
+
+	if (Camera.ShowHeatmap)
+	{
+		const uint64_t deltaTime = clockARB() - clock;
+		const float heatmapScale = 1000000.0f * Camera.HeatmapScale * Camera.HeatmapScale;
+		const float deltaTimeScaled = clamp(float(deltaTime) / heatmapScale, 0.0f, 1.0f);
+
+		pixelColor = heatmap(deltaTimeScaled);
+	}
+
+	imageStore(AccumulationImage, ivec2(launchId), accumulation);
+	imageStore(OutputImage, ivec2(launchId), vec4(pixelColor, 0));
+}
+
+void TraceGBuffer(const uvec2 launchId, const uvec2 launchSize)
+{
+    //Generate a ray from camera
+    const float tMin = 0.001;
+    const float tMax = 10000.0;
+
+    // Get uv coordinate
+    const vec2 pixel = vec2(launchId.x,launchId.y);
+    const vec2 uv = (pixel/launchSize) * 2.0 - 1.0;
+
+    // Calculate ray direction from the camera's perspective
+    vec4 target = Camera.ProjectionInverse * (vec4(uv.x, uv.y, 1, 1));
+    vec4 direction = Camera.ModelViewInverse * vec4(normalize(target.xyz * Camera.FocusDistance), 0);
+
+    // camera's position
+    vec4 origin = Camera.ModelViewInverse * vec4(0, 0, 0, 1);
+
+    Trace(origin.xyz, tMin, direction.xyz, tMax);
+
+    // The probe gather runs in a compute pass over this G-buffer.
+    imageStore(GBufferDepth, ivec2(launchId), vec4(Ray.ColorAndDistance.w));
+    imageStore(GBufferNormal, ivec2(launchId), Ray.normal);
+    imageStore(GBufferAlbedo, ivec2(launchId), vec4(Ray.ColorAndDistance.rgb, 0));
+}
+
+void ProbeTexture(const uvec2 launchId, const uvec2 launchSize)
+{
+    vec2 testUV = vec2(launchId) / vec2(launchSize);
+    uint index = lightProbeSlot[lightProbeCons.currentProbeIndex];
+    vec3 pixelColor = index != ProbeNotResident ? sqrt(texture(radianceProbeTexture, vec3(testUV, index)).rgb) : vec3(0);
+
+    imageStore(OutputImage, ivec2(launchId), vec4(pixelColor, 0));
+}
+
+void RenderPixel(const uvec2 launchId, const uvec2 launchSize)
+{
+    // RenderMode is a specialization constant, only one of these calls remains in each variant.
+    if (RenderMode == RenderModePathTraced)
+    {
+        PathTrace(launchId, launchSize);
+    }
+    else if (RenderMode == RenderModeProbeShaded)
+    {
+        TraceGBuffer(launchId, launchSize);
+    }
+    else
+    {
+        ProbeTexture(launchId, launchSize);
+    }
+}
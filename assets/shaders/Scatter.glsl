@@ -23,12 +23,12 @@ RayPayload ScatterLambertian(const Material m, const vec3 direction, const vec3
 	//Wrap up all information
 	const vec4 colorAndDistance = vec4(m.Diffuse.rgb * texColor.rgb, t);
 
-	//Scatter direction
-	const vec4 scatter = vec4(normal + RandomInUnitSphere(seed), isScattered ? 1 : 0);
+	//Scatter direction, cosine weighted (see LambertianPdf() in DirectLight.glsl)
+	const vec4 scatter = vec4(normal + RandomUnitVector(seed), isScattered ? 1 : 0);
 
 	//const vec4 colorAndDistance.rgb = vec4(1, 0, 0,t);
 
-	return RayPayload(colorAndDistance, scatter, vec4(normal,0),seed);
+	return RayPayload(colorAndDistance, scatter, vec4(normal, PackSurfaceMaterial(MaterialLambertian, 0)), seed);
 }
 
 // Metallic
@@ -43,7 +43,7 @@ RayPayload ScatterMetallic(const Material m, const vec3 direction, const vec3 no
 
 	//const vec4 colorAndDistance = vec4(1, 1, 1, t);
 
-	return RayPayload(colorAndDistance, scatter, vec4(normal, 0), seed);
+	return RayPayload(colorAndDistance, scatter, vec4(normal, PackSurfaceMaterial(MaterialMetallic, m.Fuzziness)), seed);
 }
 
 // Dielectric
@@ -60,18 +60,21 @@ RayPayload ScatterDieletric(const Material m, const vec3 direction, const vec3 n
 	const vec4 texColor = m.DiffuseTextureId >= 0 ? texture(TextureSamplers[nonuniformEXT(m.DiffuseTextureId)], texCoord) : vec4(1);
 	//const vec4 texColor = vec4(0,0,0,1);
 
+	const vec4 surface = vec4(normal, PackSurfaceMaterial(MaterialDielectric, 1 / m.RefractionIndex));
+
 	return RandomFloat(seed) < reflectProb
-		? RayPayload(vec4(texColor.rgb, t), vec4(reflect(direction, normal), 1), vec4(normal, 0), seed)
-		: RayPayload(vec4(texColor.rgb, t), vec4(refracted, 1), vec4(normal, 0), seed);
+		? RayPayload(vec4(texColor.rgb, t), vec4(reflect(direction, normal), 1), surface, seed)
+		: RayPayload(vec4(texColor.rgb, t), vec4(refracted, 1), surface, seed);
 }
 
 // Diffuse Light
 RayPayload ScatterDiffuseLight(const Material m, const float t, const vec3 normal, inout uint seed)
 {
+	// Scatter x = 1 flags the emitters that the next-event estimation also samples (triangles only, see DirectLight.glsl).
 	const vec4 colorAndDistance = vec4(m.Diffuse.rgb, t);
 	const vec4 scatter = vec4(1, 0, 0, 0);
 
-	return RayPayload(colorAndDistance, scatter, vec4(normal, 0), seed);
+	return RayPayload(colorAndDistance, scatter, vec4(normal, PackSurfaceMaterial(MaterialDiffuseLight, 0)), seed);
 }
 
 RayPayload Scatter(const Material m, const vec3 direction, const vec3 normal, const vec2 texCoord, const float t, inout uint seed)
@@ -0,0 +1,25 @@
+
+// Ray tracing pipeline backend of the tracer: the hit and miss shaders of the shader binding table fill the Ray payload.
+// RayQuery.glsl is the inline ray query counterpart used by the compute shaders, with the same interface.
+// Expects the includer to declare the Scene acceleration structure and the Ray payload (location 0).
+
+void Trace(const vec3 origin, const float tMin, const vec3 direction, const float tMax)
+{
+	traceRayEXT(
+		Scene, gl_RayFlagsOpaqueEXT, 0xff,
+		0 /*sbtRecordOffset*/, 0 /*sbtRecordStride*/, 0 /*missIndex*/,
+		origin, tMin, direction, tMax, 0 /*payload*/);
+}
+
+// Shadow ray: only the miss shader runs, and it flags the payload with a negative distance.
+bool IsOccluded(const vec3 origin, const float tMin, const vec3 direction, const float tMax)
+{
+	Ray.ColorAndDistance.w = 0;
+
+	traceRayEXT(
+		Scene, gl_RayFlagsOpaqueEXT | gl_RayFlagsTerminateOnFirstHitEXT | gl_RayFlagsSkipClosestHitShaderEXT, 0xff,
+		0 /*sbtRecordOffset*/, 0 /*sbtRecordStride*/, 0 /*missIndex*/,
+		origin, tMin, direction, tMax, 0 /*payload*/);
+
+	return Ray.ColorAndDistance.w >= 0;
+}
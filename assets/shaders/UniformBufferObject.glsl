@@ -5,6 +5,7 @@ struct UniformBufferObject
 	mat4 Projection;
 	mat4 ModelViewInverse;
 	mat4 ProjectionInverse;
+	mat4 PreviousModelView;
 	float Aperture;
 	float FocusDistance;
 	float HeatmapScale;
@@ -14,4 +15,6 @@ struct UniformBufferObject
 	uint RandomSeed;
 	bool HasSky;
 	bool ShowHeatmap;
+	bool TemporalAccumulation;
+	uint TemporalMaxHistory;
 };
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Utilities/Glm.hpp"
+
+namespace Assets
+{
+
+	// An emissive triangle, as sampled by the next-event estimation of the shaders (see Emitter.glsl).
+	struct alignas(16) Emitter final
+	{
+		// Note: vec3 and vec4 gets aligned on 16 bytes in Vulkan shaders. 
+
+		// Triangle vertices in world space (w = unused)
+		glm::vec4 V0;
+		glm::vec4 V1;
+		glm::vec4 V2;
+
+		// Emitted radiance (rgb), triangle area (w)
+		glm::vec4 EmissionAndArea;
+
+		// Emitted power, and sum of the power of this emitter and all the ones before it
+		float Power;
+		float PowerCdf;
+	};
+
+}
@@ -18,5 +18,6 @@ namespace Assets
 		Procedural() = default;
 		virtual ~Procedural() = default;;
 		virtual std::pair<glm::vec3, glm::vec3> BoundingBox() const = 0;
+		virtual bool Contains(const glm::vec3& point) const = 0;
 	};
 }
@@ -1,4 +1,5 @@
 #include "Scene.hpp"
+#include "Emitter.hpp"
 #include "Model.hpp"
 #include "Sphere.hpp"
 #include "Texture.hpp"
@@ -23,6 +24,9 @@ Scene::Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std:
 	std::vector<glm::vec4> procedurals;
 	std::vector<VkAabbPositionsKHR> aabbs;
 	std::vector<glm::uvec2> offsets;
+	std::vector<Emitter> emitters;
+
+	const float pi = 3.14159265358979f;
 
 	for (const auto& model : models_)
 	{
@@ -44,6 +48,36 @@ Scene::Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std:
 			vertices[i].MaterialIndex += materialOffset;
 		}
 
+		// Gather the emissive triangles, so that the shaders can sample them explicitly.
+		// The power is the flux emitted by the Lambertian emitter: pi * radiance luminance * area.
+		if (model.Procedural() == nullptr)
+		{
+			for (size_t i = indexOffset; i + 2 < indices.size(); i += 3)
+			{
+				const auto& v0 = vertices[vertexOffset + indices[i + 0]];
+				const auto& v1 = vertices[vertexOffset + indices[i + 1]];
+				const auto& v2 = vertices[vertexOffset + indices[i + 2]];
+				const auto& material = materials[v0.MaterialIndex];
+
+				if (material.MaterialModel != Material::Enum::DiffuseLight)
+				{
+					continue;
+				}
+
+				const float area = 0.5f * glm::length(glm::cross(v1.Position - v0.Position, v2.Position - v0.Position));
+				const float luminance = glm::dot(glm::vec3(material.Diffuse), glm::vec3(0.2126f, 0.7152f, 0.0722f));
+				const float power = pi * luminance * area;
+
+				if (power <= 0)
+				{
+					continue;
+				}
+
+				emitterPower_ += power;
+				emitters.push_back({ glm::vec4(v0.Position, 0), glm::vec4(v1.Position, 0), glm::vec4(v2.Position, 0), glm::vec4(glm::vec3(material.Diffuse), area), power, emitterPower_ });
+			}
+		}
+
 		// Add optional procedurals.
 		const auto* const sphere = dynamic_cast<const Sphere*>(model.Procedural());
 		if (sphere != nullptr)
@@ -61,13 +95,25 @@ Scene::Scene(Vulkan::CommandPool& commandPool, std::vector<Model>&& models, std:
 
 	constexpr auto flags = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, vertices, vertexBuffer_, vertexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, indices, indexBuffer_, indexBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Materials", flags, materials, materialBuffer_, materialBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Offsets", flags, offsets, offsetBuffer_, offsetBufferMemory_);
+	// The buffers the light probe bake reads are shared with the compute queue, the AABBs only feed the BLAS build.
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, vertices, vertexBuffer_, vertexBufferMemory_, VK_SHARING_MODE_CONCURRENT);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, indices, indexBuffer_, indexBufferMemory_, VK_SHARING_MODE_CONCURRENT);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Materials", flags, materials, materialBuffer_, materialBufferMemory_, VK_SHARING_MODE_CONCURRENT);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Offsets", flags, offsets, offsetBuffer_, offsetBufferMemory_, VK_SHARING_MODE_CONCURRENT);
 
 	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "AABBs", VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR | flags, aabbs, aabbBuffer_, aabbBufferMemory_);
-	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Procedurals", flags, procedurals, proceduralBuffer_, proceduralBufferMemory_);
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Procedurals", flags, procedurals, proceduralBuffer_, proceduralBufferMemory_, VK_SHARING_MODE_CONCURRENT);
+
+	// Scenes without emissive triangles still get a (zero power) emitter, the shaders then skip the light sampling.
+	emitterCount_ = static_cast<uint32_t>(emitters.size());
+
+	if (emitters.empty())
+	{
+		emitters.emplace_back();
+	}
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(commandPool, "Emitters", flags, emitters, emitterBuffer_, emitterBufferMemory_, VK_SHARING_MODE_CONCURRENT);
 
 	
 	// Upload all textures
@@ -88,6 +134,8 @@ Scene::~Scene()
 	textureSamplerHandles_.clear();
 	textureImageViewHandles_.clear();
 	textureImages_.clear();
+	emitterBuffer_.reset();
+	emitterBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	proceduralBuffer_.reset();
 	proceduralBufferMemory_.reset(); // release memory after bound buffer has been destroyed
 	aabbBuffer_.reset();
@@ -31,6 +31,7 @@ namespace Assets
 		~Scene();
 
 		const std::vector<Model>& Models() const { return models_; }
+		const std::vector<Texture>& Textures() const { return textures_; }
 		bool HasProcedurals() const { return static_cast<bool>(proceduralBuffer_); }
 
 		const Vulkan::Buffer& VertexBuffer() const { return *vertexBuffer_; }
@@ -39,6 +40,9 @@ namespace Assets
 		const Vulkan::Buffer& OffsetsBuffer() const { return *offsetBuffer_; }
 		const Vulkan::Buffer& AabbBuffer() const { return *aabbBuffer_; }
 		const Vulkan::Buffer& ProceduralBuffer() const { return *proceduralBuffer_; }
+		const Vulkan::Buffer& EmitterBuffer() const { return *emitterBuffer_; }
+		uint32_t EmitterCount() const { return emitterCount_; }
+		float EmitterPower() const { return emitterPower_; }
 		const std::vector<VkImageView> TextureImageViews() const { return textureImageViewHandles_; }
 		const std::vector<VkSampler> TextureSamplers() const { return textureSamplerHandles_; }
 
@@ -65,6 +69,11 @@ namespace Assets
 		std::unique_ptr<Vulkan::Buffer> proceduralBuffer_;
 		std::unique_ptr<Vulkan::DeviceMemory> proceduralBufferMemory_;
 
+		std::unique_ptr<Vulkan::Buffer> emitterBuffer_;
+		std::unique_ptr<Vulkan::DeviceMemory> emitterBufferMemory_;
+		uint32_t emitterCount_{};
+		float emitterPower_{};
+
 		std::vector<std::unique_ptr<TextureImage>> textureImages_;
 		std::vector<VkImageView> textureImageViewHandles_;
 		std::vector<VkSampler> textureSamplerHandles_;
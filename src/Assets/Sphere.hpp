@@ -23,6 +23,12 @@ namespace Assets
 			return std::make_pair(Center - Radius, Center + Radius);
 		}
 
+		bool Contains(const glm::vec3& point) const override
+		{
+			const auto offset = point - Center;
+			return glm::dot(offset, offset) <= Radius * Radius;
+		}
+
 	};
 
 }
\ No newline at end of file
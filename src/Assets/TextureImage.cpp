@@ -22,8 +22,10 @@ TextureImage::TextureImage(Vulkan::CommandPool& commandPool, const Texture& text
 	std::memcpy(data, texture.Pixels(), imageSize);
 	stagingBufferMemory.Unmap();
 
-	// Create the device side image, memory, view and sampler.
-	image_.reset(new Vulkan::Image(device, VkExtent2D{ static_cast<uint32_t>(texture.Width()), static_cast<uint32_t>(texture.Height()) }, VK_FORMAT_R8G8B8A8_UNORM));
+	// Create the device side image, memory, view and sampler. The light probe bake samples it on the compute queue.
+	const VkExtent2D extent{ static_cast<uint32_t>(texture.Width()), static_cast<uint32_t>(texture.Height()) };
+	image_.reset(new Vulkan::Image(device, extent, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 0, VK_SHARING_MODE_CONCURRENT));
 	imageMemory_.reset(new Vulkan::DeviceMemory(image_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	imageView_.reset(new Vulkan::ImageView(device, image_->Handle(), image_->Format(), VK_IMAGE_ASPECT_COLOR_BIT));
 	sampler_.reset(new Vulkan::Sampler(device, Vulkan::SamplerConfig()));
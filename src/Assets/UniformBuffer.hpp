@@ -20,6 +20,7 @@ namespace Assets
 		glm::mat4 Projection;
 		glm::mat4 ModelViewInverse;
 		glm::mat4 ProjectionInverse;
+		glm::mat4 PreviousModelView; // camera of the previous frame, for the temporal reprojection
 		float Aperture;
 		float FocusDistance;
 		float HeatmapScale;
@@ -29,6 +30,8 @@ namespace Assets
 		uint32_t RandomSeed;
 		uint32_t HasSky; // bool
 		uint32_t ShowHeatmap; // bool
+		uint32_t TemporalAccumulation; // bool
+		uint32_t TemporalMaxHistory;
 	};
 
 	class UniformBuffer
@@ -86,6 +86,19 @@ bool ModelViewController::OnMouseButton(const int button, const int action, cons
 	return true;
 }
 
+bool ModelViewController::IsMoving() const
+{
+	return
+		cameraMovingLeft_ ||
+		cameraMovingRight_ ||
+		cameraMovingBackward_ ||
+		cameraMovingForward_ ||
+		cameraMovingDown_ ||
+		cameraMovingUp_ ||
+		cameraRotY_ != 0 ||
+		cameraRotX_ != 0;
+}
+
 bool ModelViewController::UpdateCamera(const double speed, const double timeDelta)
 {
 	const auto d = static_cast<float>(speed * timeDelta);
@@ -100,15 +113,7 @@ bool ModelViewController::UpdateCamera(const double speed, const double timeDelt
 	const float rotationDiv = 300;
 	Rotate(cameraRotX_ / rotationDiv, cameraRotY_ / rotationDiv);
 
-	const bool updated =
-		cameraMovingLeft_ ||
-		cameraMovingRight_ ||
-		cameraMovingBackward_ ||
-		cameraMovingForward_ ||
-		cameraMovingDown_ ||
-		cameraMovingUp_ ||
-		cameraRotY_ != 0 ||
-		cameraRotX_ != 0;
+	const bool updated = IsMoving();
 
 	cameraRotY_ = 0;
 	cameraRotX_ = 0;
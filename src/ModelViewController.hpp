@@ -15,6 +15,9 @@ public:
 	bool OnMouseButton(int button, int action, int mods);
 	bool UpdateCamera(double speed, double timeDelta);
 
+	// Whether the next UpdateCamera() call moves the camera.
+	bool IsMoving() const;
+
 private:
 
 	void MoveForward(float d);
@@ -21,6 +21,28 @@ Options::Options(const int argc, const char* argv[])
 		("samples", value<uint32_t>(&Samples)->default_value(8), "The number of ray samples per pixel.")
 		("bounces", value<uint32_t>(&Bounces)->default_value(16), "The maximum number of bounces per ray.")
 		("max-samples", value<uint32_t>(&MaxSamples)->default_value(64 * 1024), "The maximum number of accumulated ray samples per pixel.")
+		("ray-query", bool_switch(&RayQuery)->default_value(false), "Trace the scene and bake the light probes with inline ray queries from compute shaders, instead of the ray tracing pipeline.")
+		("temporal", bool_switch(&Temporal)->default_value(false), "Reproject the accumulated samples when the camera moves, instead of starting over.")
+		("temporal-max-history", value<uint32_t>(&TemporalMaxHistory)->default_value(32), "The maximum number of samples per pixel the reprojected history is weighted as.")
+		;
+
+	options_description lightProbe("Light probe options", lineLength);
+	lightProbe.add_options()
+		("probe-bake-budget", value<uint32_t>(&ProbeBakeBudget)->default_value(16), "The number of light probe bake rays traced per frame (in millions).")
+		("probe-resolution", value<uint32_t>(&ProbeResolution)->default_value(64), "The octahedral radiance resolution of each light probe.")
+		("probe-depth-resolution", value<uint32_t>(&ProbeDepthResolution)->default_value(16), "The octahedral depth resolution of each light probe.")
+		("probe-format", value<uint32_t>(&ProbeFormat)->default_value(4), "The light probe radiance format (0 = RGBA16F, 1 = RGBA32F, 2 = RGBA8, 3 = B10G11R11 packed float, 4 = E5B9G9R9 shared exponent).")
+		("probe-samples", value<uint32_t>(&ProbeSamples)->default_value(500), "The number of bake samples per light probe texel.")
+		("probe-adaptive-threshold", value<float>(&ProbeAdaptiveThreshold)->default_value(0.05f), "The relative error at which a light probe texel stops being sampled by the bake (0 = uniform sampling).")
+		("probe-spacing", value<float>(&ProbeSpacing)->default_value(0.0f), "The distance between light probes (0 = automatic, from the scene volume, or 1 for the finest probe cascade).")
+		("probe-max-count", value<uint32_t>(&ProbeMaxCount)->default_value(512), "The maximum number of light probes placed in a scene.")
+		("probe-cascades", value<uint32_t>(&ProbeCascades)->default_value(0), "The number of light probe cascades following the camera (0 = a single grid fitted to the scene).")
+		("probe-cascade-resolution", value<uint32_t>(&ProbeCascadeResolution)->default_value(8), "The number of light probes along each axis of a light probe cascade.")
+		("probe-resident-count", value<uint32_t>(&ProbeResidentCount)->default_value(0), "The number of light probes kept in GPU memory, the other ones being paged out to host memory (0 = all).")
+		("probe-cache", value<std::string>(&ProbeCacheDirectory)->default_value("probe_cache"), "The directory where baked light probes are cached (empty = no cache).")
+		("probe-update-count", value<uint32_t>(&ProbeUpdateCount)->default_value(0), "The number of baked light probes relit every frame (0 = static probes).")
+		("probe-update-samples", value<uint32_t>(&ProbeUpdateSamples)->default_value(4), "The number of samples per texel of a light probe update.")
+		("probe-hysteresis", value<float>(&ProbeHysteresis)->default_value(0.97f), "The weight of the previous light probe data when blending in an update.")
 		;
 
 	options_description scene("Scene options", lineLength);
@@ -45,10 +67,12 @@ Options::Options(const int argc, const char* argv[])
 	desc.add_options()
 		("help", "Display help message.")
 		("benchmark", bool_switch(&Benchmark)->default_value(false), "Run the application in benchmark mode.")
+		("bake-probes", bool_switch(&BakeProbes)->default_value(false), "Bake the light probes of the scene into the probe cache without opening a window, then exit.")
 		;
 
 	desc.add(benchmark);
 	desc.add(renderer);
+	desc.add(lightProbe);
 	desc.add(scene);
 	desc.add(vulkan);
 	desc.add(window);
@@ -69,6 +93,77 @@ Options::Options(const int argc, const char* argv[])
 		Throw(std::out_of_range("scene index is too large"));
 	}
 
+	if (ProbeBakeBudget == 0)
+	{
+		Throw(std::out_of_range("invalid light probe bake budget"));
+	}
+
+	if (ProbeResolution < 2 || ProbeResolution > 1024 || ProbeDepthResolution < 2 || ProbeDepthResolution > 1024)
+	{
+		Throw(std::out_of_range("invalid light probe resolution"));
+	}
+
+	if (ProbeFormat > 4)
+	{
+		Throw(std::out_of_range("invalid light probe format"));
+	}
+
+	if (ProbeSamples == 0)
+	{
+		Throw(std::out_of_range("invalid light probe sample count"));
+	}
+
+	if (ProbeSpacing < 0.0f)
+	{
+		Throw(std::out_of_range("invalid light probe spacing"));
+	}
+
+	// Each resident probe is a layer of the probe atlas. Vulkan only guarantees 256 image array layers, the device limit
+	// (maxImageArrayLayers) is checked when the atlas is created.
+	const uint32_t maxProbeCount = ProbeResidentCount != 0 ? 1024 * 1024 : 2048;
+
+	if (ProbeResidentCount > 2048)
+	{
+		Throw(std::out_of_range("invalid light probe resident count"));
+	}
+
+	if (ProbeMaxCount == 0 || ProbeMaxCount > maxProbeCount)
+	{
+		Throw(std::out_of_range("invalid light probe max count"));
+	}
+
+	if (ProbeCascades > 4)
+	{
+		Throw(std::out_of_range("invalid light probe cascade count"));
+	}
+
+	// The cascades share the probe atlas, with the same limit as the max count.
+	if (ProbeCascadeResolution < 2 || ProbeCascades * ProbeCascadeResolution * ProbeCascadeResolution * ProbeCascadeResolution > maxProbeCount)
+	{
+		Throw(std::out_of_range("invalid light probe cascade resolution"));
+	}
+
+	// The offline bake writes the probe cache, which only holds a single grid of resident probes.
+	if (BakeProbes && (ProbeCacheDirectory.empty() || ProbeCascades != 0 || ProbeResidentCount != 0))
+	{
+		Throw(std::invalid_argument("light probe bake requires a probe cache, and neither probe cascades nor a resident count"));
+	}
+
+	if (ProbeUpdateSamples == 0)
+	{
+		Throw(std::out_of_range("invalid light probe update sample count"));
+	}
+
+	if (ProbeAdaptiveThreshold < 0.0f)
+	{
+		Throw(std::out_of_range("invalid light probe adaptive threshold"));
+	}
+
+	if (ProbeHysteresis <= 0.0f || ProbeHysteresis >= 1.0f)
+	{
+		Throw(std::out_of_range("invalid light probe hysteresis"));
+	}
+
 	if (PresentMode > 3)
 	{
 		Throw(std::out_of_range("invalid present mode"));
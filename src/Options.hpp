@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <exception>
+#include <string>
 #include <vector>
 
 class Options final
@@ -21,6 +22,7 @@ public:
 
 	// Application options.
 	bool Benchmark{};
+	bool BakeProbes{};
 	
 	// Benchmark options.
 	bool BenchmarkNextScenes{};
@@ -30,6 +32,26 @@ public:
 	uint32_t Samples{};
 	uint32_t Bounces{};
 	uint32_t MaxSamples{};
+	bool RayQuery{};
+	bool Temporal{};
+	uint32_t TemporalMaxHistory{};
+
+	// Light probe options.
+	uint32_t ProbeBakeBudget{};
+	uint32_t ProbeResolution{};
+	uint32_t ProbeDepthResolution{};
+	uint32_t ProbeFormat{};
+	uint32_t ProbeSamples{};
+	float ProbeAdaptiveThreshold{};
+	float ProbeSpacing{};
+	uint32_t ProbeMaxCount{};
+	uint32_t ProbeCascades{};
+	uint32_t ProbeCascadeResolution{};
+	uint32_t ProbeResidentCount{};
+	std::string ProbeCacheDirectory;
+	uint32_t ProbeUpdateCount{};
+	uint32_t ProbeUpdateSamples{};
+	float ProbeHysteresis{};
 
 	// Scene options.
 	uint32_t SceneIndex{};
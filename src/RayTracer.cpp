@@ -8,6 +8,7 @@
 #include "Utilities/Exception.hpp"
 #include "Utilities/Glm.hpp"
 #include "Vulkan/Device.hpp"
+#include "Vulkan/GpuTimer.hpp"
 #include "Vulkan/SwapChain.hpp"
 #include "Vulkan/Window.hpp"
 #include <iostream>
@@ -21,13 +22,42 @@ namespace
 #else
 		true;
 #endif
+
+	const VkFormat ProbeFormats[] =
+	{
+		VK_FORMAT_R16G16B16A16_SFLOAT,
+		VK_FORMAT_R32G32B32A32_SFLOAT,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		VK_FORMAT_B10G11R11_UFLOAT_PACK32,
+		VK_FORMAT_E5B9G9R9_UFLOAT_PACK32
+	};
 }
 
 RayTracer::RayTracer(const UserSettings& userSettings, const Vulkan::WindowConfig& windowConfig, const VkPresentModeKHR presentMode) :
 	Application(windowConfig, presentMode, EnableValidationLayers),
 	userSettings_(userSettings)
 {
-	CheckFramebufferSize();
+	Vulkan::RayTracing::LightProbeConfig lightProbeConfig;
+	lightProbeConfig.RadianceResolution = userSettings.ProbeResolution;
+	lightProbeConfig.DepthResolution = userSettings.ProbeDepthResolution;
+	lightProbeConfig.RadianceFormat = ProbeFormats[userSettings.ProbeFormat];
+	lightProbeConfig.SamplesPerTexel = userSettings.ProbeSamples;
+	lightProbeConfig.AdaptiveThreshold = userSettings.ProbeAdaptiveThreshold;
+	lightProbeConfig.ProbeSpacing = userSettings.ProbeSpacing;
+	lightProbeConfig.MaxProbeCount = userSettings.ProbeMaxCount;
+	lightProbeConfig.Cascades = userSettings.ProbeCascades;
+	lightProbeConfig.CascadeResolution = userSettings.ProbeCascadeResolution;
+	lightProbeConfig.ResidentProbeCount = userSettings.ProbeResidentCount;
+	lightProbeConfig.Bounces = userSettings.NumberOfBounces;
+	lightProbeConfig.CacheDirectory = userSettings.ProbeCacheDirectory;
+
+	setLightProbeConfig(lightProbeConfig);
+	setRayQuery(userSettings.RayQuery);
+
+	if (!IsHeadless())
+	{
+		CheckFramebufferSize();
+	}
 }
 
 RayTracer::~RayTracer()
@@ -45,6 +75,7 @@ Assets::UniformBufferObject RayTracer::GetUniformBufferObject(const VkExtent2D e
 	ubo.Projection[1][1] *= -1; // Inverting Y for Vulkan, https://matthewwellings.com/blog/the-new-vulkan-coordinate-system/
 	ubo.ModelViewInverse = glm::inverse(ubo.ModelView);
 	ubo.ProjectionInverse = glm::inverse(ubo.Projection);
+	ubo.PreviousModelView = previousModelView_;
 	ubo.Aperture = userSettings_.Aperture;
 	ubo.FocusDistance = userSettings_.FocusDistance;
 	ubo.TotalNumberOfSamples = totalNumberOfSamples_;
@@ -54,6 +85,8 @@ Assets::UniformBufferObject RayTracer::GetUniformBufferObject(const VkExtent2D e
 	ubo.HasSky = init.HasSky;
 	ubo.ShowHeatmap = userSettings_.ShowHeatmap;
 	ubo.HeatmapScale = userSettings_.HeatmapScale;
+	ubo.TemporalAccumulation = userSettings_.TemporalAccumulation;
+	ubo.TemporalMaxHistory = userSettings_.TemporalMaxHistory;
 
 	return ubo;
 }
@@ -81,6 +114,10 @@ void RayTracer::SetPhysicalDevice(
 	deviceFeatures.samplerAnisotropy = true;
 	deviceFeatures.shaderInt64 = true;
 
+	// The light probe bake writes its radiance images through a view without a format qualifier (see LightProbeConfig).
+	deviceFeatures.shaderStorageImageReadWithoutFormat = true;
+	deviceFeatures.shaderStorageImageWriteWithoutFormat = true;
+
 	Application::SetPhysicalDevice(physicalDevice, requiredExtensions, deviceFeatures, &shaderClockFeatures);
 }
 
@@ -88,6 +125,14 @@ void RayTracer::OnDeviceSet()
 {
 	Application::OnDeviceSet();
 
+	// The inline ray query backend is optional, unlike the ray tracing pipeline.
+	if (userSettings_.RayQuery && !HasRayQuery())
+	{
+		Throw(std::runtime_error("--ray-query requires a device supporting VK_KHR_ray_query"));
+	}
+
+	userSettings_.HasRayQuery = HasRayQuery();
+
 	LoadScene(userSettings_.SceneIndex);
 	CreateAccelerationStructures();
 	userSettings_.MaxLightProbeIndex = Application::getLightProbeIndex() - 1;
@@ -130,22 +175,34 @@ void RayTracer::DrawFrame()
 	}
 	
 
-	// Check if the accumulation buffer needs to be reset.
+	// Check if the accumulation buffer needs to be reset. With temporal accumulation, the camera moves are reprojected
+	// by the path tracer instead (see RenderModes.glsl), only the sample budget starts over.
+	const bool cameraMoved = cameraMoved_ || modelViewController_.IsMoving();
+
 	if (resetAccumulation_ || 
+		(cameraMoved && !userSettings_.TemporalAccumulation) ||
 		userSettings_.RequiresAccumulationReset(previousSettings_) || 
 		!userSettings_.AccumulateRays)
 	{
 		totalNumberOfSamples_ = 0;
-		resetAccumulation_ = false;
+		sampleBudgetStart_ = 0;
+	}
+	else if (cameraMoved)
+	{
+		sampleBudgetStart_ = totalNumberOfSamples_;
 	}
 
+	resetAccumulation_ = false;
+	cameraMoved_ = false;
 	previousSettings_ = userSettings_;
 
 	// Keep track of our sample count.
-	numberOfSamples_ = glm::clamp(userSettings_.MaxNumberOfSamples - totalNumberOfSamples_, 0u, userSettings_.NumberOfSamples);
+	numberOfSamples_ = glm::clamp(userSettings_.MaxNumberOfSamples - (totalNumberOfSamples_ - sampleBudgetStart_), 0u, userSettings_.NumberOfSamples);
 	totalNumberOfSamples_ += numberOfSamples_;
 
 	Application::DrawFrame();
+
+	previousModelView_ = modelViewController_.ModelView();
 }
 
 void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
@@ -155,15 +212,21 @@ void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
 	time_ = Window().GetTime();
 	const auto timeDelta = time_ - prevTime;
 
-	// Update the camera position / angle.
-	resetAccumulation_ = modelViewController_.UpdateCamera(cameraInitialSate_.ControlSpeed, timeDelta);
+	// Update the camera position / angle, DrawFrame() already accounted for the motion.
+	modelViewController_.UpdateCamera(cameraInitialSate_.ControlSpeed, timeDelta);
 
 	// Check the current state of the benchmark, update it for the new frame.
 	CheckAndUpdateBenchmarkState(prevTime);
 
 	Application::setIsProbeTexture(userSettings_.ShowLightProbeTexture);
 	Application::setIsRaytrace(userSettings_.ShowOriginalRaytrace);
+	Application::setProbeSHShading(userSettings_.ProbeSHShading);
+	Application::setRasterisedPrimary(userSettings_.RasterisedPrimary);
+	Application::setRayQuery(userSettings_.RayQuery);
+	Application::setTemporalAccumulation(userSettings_.TemporalAccumulation);
 	Application::setCurrentIndex(userSettings_.CurrentLightProbeIndex);
+	Application::setProbeBakeBudget(uint64_t(userSettings_.ProbeBakeBudget) * 1000000);
+	Application::setProbeUpdate(userSettings_.ProbeUpdateCount, userSettings_.ProbeUpdateSamples, userSettings_.ProbeHysteresis);
 
 	// Render the scene
 	userSettings_.IsRayTraced
@@ -184,9 +247,14 @@ void RayTracer::Render(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
 			/ (timeDelta * 1000000000));
 
 		stats.TotalSamples = totalNumberOfSamples_;
+		stats.ProbeBakeProgress = Application::getProbeBakeProgress();
 	}
 
+	stats.GpuPassTimes = GpuPassTimes();
+
+	GpuTimer().Begin(commandBuffer, "ImGui");
 	userInterface_->Render(commandBuffer, SwapChainFrameBuffer(imageIndex), stats);
+	GpuTimer().End(commandBuffer);
 }
 
 void RayTracer::OnKey(int key, int scancode, int action, int mods)
@@ -222,7 +290,7 @@ void RayTracer::OnKey(int key, int scancode, int action, int mods)
 	// Camera motions
 	if (!userSettings_.Benchmark)
 	{
-		resetAccumulation_ |= modelViewController_.OnKey(key, scancode, action, mods);
+		cameraMoved_ |= modelViewController_.OnKey(key, scancode, action, mods);
 	}
 }
 
@@ -237,7 +305,7 @@ void RayTracer::OnCursorPosition(const double xpos, const double ypos)
 	}
 
 	// Camera motions
-	resetAccumulation_ |= modelViewController_.OnCursorPosition(xpos, ypos);
+	cameraMoved_ |= modelViewController_.OnCursorPosition(xpos, ypos);
 }
 
 void RayTracer::OnMouseButton(const int button, const int action, const int mods)
@@ -250,7 +318,7 @@ void RayTracer::OnMouseButton(const int button, const int action, const int mods
 	}
 
 	// Camera motions
-	resetAccumulation_ |= modelViewController_.OnMouseButton(button, action, mods);
+	cameraMoved_ |= modelViewController_.OnMouseButton(button, action, mods);
 }
 
 void RayTracer::OnScroll(const double xoffset, const double yoffset)
@@ -319,6 +387,12 @@ void RayTracer::CheckAndUpdateBenchmarkState(double prevTime)
 		if (periodTotalFrames_ != 0 && static_cast<uint64_t>(prevTotalTime / period) != static_cast<uint64_t>(totalTime / period))
 		{
 			std::cout << "Benchmark: " << periodTotalFrames_ / totalTime << " fps" << std::endl;
+
+			for (const auto& pass : GpuPassTimes())
+			{
+				std::cout << "Benchmark: " << pass.Name << " " << pass.AverageMilliseconds << " ms (GPU)" << std::endl;
+			}
+
 			periodInitialTime_ = time_;
 			periodTotalFrames_ = 0;
 		}
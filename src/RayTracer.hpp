@@ -57,6 +57,12 @@ private:
 	uint32_t numberOfSamples_{};
 	bool resetAccumulation_{};
 
+	// Temporal accumulation: the camera moves keep the accumulated samples, the sample budget restarts from
+	// sampleBudgetStart_ instead. The reprojection needs the camera of the previous frame.
+	bool cameraMoved_{};
+	uint32_t sampleBudgetStart_{};
+	glm::mat4 previousModelView_{};
+
 	// Benchmark stats
 	double sceneInitialTime_{};
 	double periodInitialTime_{};
@@ -217,6 +217,12 @@ void UserInterface::DrawSettings()
 
 		ImGui::Checkbox("Show light probe texture", &Settings().ShowLightProbeTexture);
 		ImGui::Checkbox("Show original raytracing scene", &Settings().ShowOriginalRaytrace);
+		ImGui::Checkbox("Shade probes from SH irradiance", &Settings().ProbeSHShading);
+		ImGui::Checkbox("Rasterise primary visibility", &Settings().RasterisedPrimary);
+		if (Settings().HasRayQuery)
+		{
+			ImGui::Checkbox("Trace with ray queries", &Settings().RayQuery);
+		}
 
 		std::string str = "Current probe Index: " + std::to_string(Settings().CurrentLightProbeIndex);
 		const char* cstr = str.c_str();
@@ -227,8 +233,17 @@ void UserInterface::DrawSettings()
 			NextProbeTexture();
 		}
 
+		uint32_t min = 1, max = 256;
+		ImGui::SliderScalar("Probe bake budget (Mrays/frame)", ImGuiDataType_U32, &Settings().ProbeBakeBudget, &min, &max);
+		min = 0, max = 64;
+		ImGui::SliderScalar("Probe updates per frame", ImGuiDataType_U32, &Settings().ProbeUpdateCount, &min, &max);
+		ImGui::SliderFloat("Probe hysteresis", &Settings().ProbeHysteresis, 0.5f, 0.99f);
+
 		ImGui::Checkbox("Accumulate rays between frames", &Settings().AccumulateRays);
-		uint32_t min = 1, max = 128;
+		ImGui::Checkbox("Reproject accumulation on camera moves", &Settings().TemporalAccumulation);
+		min = 1, max = 256;
+		ImGui::SliderScalar("Max history (samples)", ImGuiDataType_U32, &Settings().TemporalMaxHistory, &min, &max);
+		min = 1, max = 128;
 		ImGui::SliderScalar("Samples", ImGuiDataType_U32, &Settings().NumberOfSamples, &min, &max);
 		min = 1, max = 32;
 		ImGui::SliderScalar("Bounces", ImGuiDataType_U32, &Settings().NumberOfBounces, &min, &max);
@@ -279,6 +294,18 @@ void UserInterface::DrawOverlay(const Statistics& statistics)
 		ImGui::Text("Frame rate: %.1f fps", statistics.FrameRate);
 		ImGui::Text("Primary ray rate: %.2f Gr/s", statistics.RayRate);
 		ImGui::Text("Accumulated samples:  %u", statistics.TotalSamples);
+		ImGui::Text("Light probe bake: %.1f%%", statistics.ProbeBakeProgress * 100.0f);
+
+		if (!statistics.GpuPassTimes.empty())
+		{
+			ImGui::Separator();
+			ImGui::Text("GPU time (last / average):");
+
+			for (const auto& pass : statistics.GpuPassTimes)
+			{
+				ImGui::Text("%s: %.2f / %.2f ms", pass.Name, pass.Milliseconds, pass.AverageMilliseconds);
+			}
+		}
 	}
 	ImGui::End();
 }
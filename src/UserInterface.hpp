@@ -1,6 +1,8 @@
 #pragma once
+#include "Vulkan/GpuTimer.hpp"
 #include "Vulkan/Vulkan.hpp"
 #include <memory>
+#include <vector>
 
 namespace Vulkan
 {
@@ -20,6 +22,8 @@ struct Statistics final
 	float FrameRate;
 	float RayRate;
 	uint32_t TotalSamples;
+	float ProbeBakeProgress;
+	std::vector<Vulkan::GpuPassTime> GpuPassTimes;
 };
 
 class UserInterface final
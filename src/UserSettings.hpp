@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 struct UserSettings final
 {
 	// Application
@@ -18,9 +20,30 @@ struct UserSettings final
 	uint32_t NumberOfSamples;
 	uint32_t NumberOfBounces;
 	uint32_t MaxNumberOfSamples;
+	bool RayQuery;
+	bool HasRayQuery = false;
+	bool TemporalAccumulation;
+	uint32_t TemporalMaxHistory;
 	uint32_t CurrentLightProbeIndex = 0;
 	uint32_t MaxLightProbeIndex = 0;
 
+	// Light probes
+	uint32_t ProbeBakeBudget;
+	uint32_t ProbeResolution;
+	uint32_t ProbeDepthResolution;
+	uint32_t ProbeFormat;
+	uint32_t ProbeSamples;
+	float ProbeAdaptiveThreshold;
+	float ProbeSpacing;
+	uint32_t ProbeMaxCount;
+	uint32_t ProbeCascades;
+	uint32_t ProbeCascadeResolution;
+	uint32_t ProbeResidentCount;
+	std::string ProbeCacheDirectory;
+	uint32_t ProbeUpdateCount;
+	uint32_t ProbeUpdateSamples;
+	float ProbeHysteresis;
+
 	// Camera
 	float FieldOfView;
 	float Aperture;
@@ -36,6 +59,8 @@ struct UserSettings final
 
 	bool ShowLightProbeTexture;
 	bool ShowOriginalRaytrace;
+	bool ProbeSHShading;
+	bool RasterisedPrimary;
 
 	inline const static float FieldOfViewMinValue = 10.0f;
 	inline const static float FieldOfViewMaxValue = 90.0f;
@@ -45,6 +70,8 @@ struct UserSettings final
 		return
 			IsRayTraced != prev.IsRayTraced ||
 			AccumulateRays != prev.AccumulateRays ||
+			TemporalAccumulation != prev.TemporalAccumulation ||
+			ShowOriginalRaytrace != prev.ShowOriginalRaytrace ||
 			NumberOfBounces != prev.NumberOfBounces ||
 			FieldOfView != prev.FieldOfView ||
 			Aperture != prev.Aperture ||
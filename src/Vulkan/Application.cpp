@@ -7,6 +7,7 @@
 #include "Device.hpp"
 #include "Fence.hpp"
 #include "FrameBuffer.hpp"
+#include "GpuTimer.hpp"
 #include "GraphicsPipeline.hpp"
 #include "Instance.hpp"
 #include "PipelineLayout.hpp"
@@ -14,6 +15,7 @@
 #include "Semaphore.hpp"
 #include "Surface.hpp"
 #include "SwapChain.hpp"
+#include "TimelineSemaphore.hpp"
 #include "Window.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
@@ -30,10 +32,10 @@ Application::Application(const WindowConfig& windowConfig, const VkPresentModeKH
 		? std::vector<const char*>{"VK_LAYER_KHRONOS_validation"}
 		: std::vector<const char*>();
 
-	window_.reset(new class Window(windowConfig));
-	instance_.reset(new Instance(*window_, validationLayers, VK_API_VERSION_1_2));
+	window_.reset(windowConfig.Headless ? nullptr : new class Window(windowConfig));
+	instance_.reset(new Instance(window_.get(), validationLayers, VK_API_VERSION_1_2));
 	debugUtilsMessenger_.reset(enableValidationLayers ? new DebugUtilsMessenger(*instance_, VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT) : nullptr);
-	surface_.reset(new Surface(*instance_));
+	surface_.reset(window_ ? new Surface(*instance_) : nullptr);
 }
 
 Application::~Application()
@@ -70,11 +72,13 @@ void Application::SetPhysicalDevice(VkPhysicalDevice physicalDevice)
 		Throw(std::logic_error("physical device has already been set"));
 	}
 
-	std::vector<const char*> requiredExtensions = 
+	std::vector<const char*> requiredExtensions;
+
+	if (!IsHeadless())
 	{
 		// VK_KHR_swapchain
-		VK_KHR_SWAPCHAIN_EXTENSION_NAME
-	};
+		requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
 
 	VkPhysicalDeviceFeatures deviceFeatures = {};
 	
@@ -82,7 +86,10 @@ void Application::SetPhysicalDevice(VkPhysicalDevice physicalDevice)
 	OnDeviceSet();
 
 	// Create swap chain and command buffers.
-	CreateSwapChain();
+	if (!IsHeadless())
+	{
+		CreateSwapChain();
+	}
 }
 
 void Application::Run()
@@ -92,6 +99,11 @@ void Application::Run()
 		Throw(std::logic_error("physical device has not been set"));
 	}
 
+	if (IsHeadless())
+	{
+		Throw(std::logic_error("cannot run a headless application"));
+	}
+
 	currentFrame_ = 0;
 
 	window_->DrawFrame = [this]() { DrawFrame(); };
@@ -109,7 +121,7 @@ void Application::SetPhysicalDevice(
 	VkPhysicalDeviceFeatures& deviceFeatures,
 	void* nextDeviceFeatures)
 {
-	device_.reset(new class Device(physicalDevice, *surface_, requiredExtensions, deviceFeatures, nextDeviceFeatures));
+	device_.reset(new class Device(physicalDevice, *instance_, surface_.get(), requiredExtensions, deviceFeatures, nextDeviceFeatures));
 	commandPool_.reset(new class CommandPool(*device_, device_->GraphicsFamilyIndex(), true));
 }
 
@@ -144,10 +156,12 @@ void Application::CreateSwapChain()
 	}
 
 	commandBuffers_.reset(new CommandBuffers(*commandPool_, static_cast<uint32_t>(swapChainFramebuffers_.size())));
+	gpuTimer_.reset(new class GpuTimer(*device_, device_->GraphicsFamilyIndex(), swapChainFramebuffers_.size()));
 }
 
 void Application::DeleteSwapChain()
 {
+	gpuTimer_.reset();
 	commandBuffers_.reset();
 	swapChainFramebuffers_.clear();
 	graphicsPipeline_.reset();
@@ -184,32 +198,53 @@ void Application::DrawFrame()
 	}
 
 	const auto commandBuffer = commandBuffers_->Begin(imageIndex);
+	gpuTimer_->BeginFrame(commandBuffer, imageIndex);
 	Render(commandBuffer, imageIndex);
 	commandBuffers_->End(imageIndex);
 
 	UpdateUniformBuffer(imageIndex);
+	OnFrameRecorded(imageIndex);
+
+	// The swapchain semaphores come first, the values of these binary semaphores are ignored.
+	frameWaitSemaphores_.insert(frameWaitSemaphores_.begin(), imageAvailableSemaphore);
+	frameWaitValues_.insert(frameWaitValues_.begin(), 0);
+	frameWaitStages_.insert(frameWaitStages_.begin(), VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	frameSignalSemaphores_.insert(frameSignalSemaphores_.begin(), renderFinishedSemaphore);
+	frameSignalValues_.insert(frameSignalValues_.begin(), 0);
+
+	VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = static_cast<uint32_t>(frameWaitValues_.size());
+	timelineInfo.pWaitSemaphoreValues = frameWaitValues_.data();
+	timelineInfo.signalSemaphoreValueCount = static_cast<uint32_t>(frameSignalValues_.size());
+	timelineInfo.pSignalSemaphoreValues = frameSignalValues_.data();
 
 	VkSubmitInfo submitInfo = {};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
 
 	VkCommandBuffer commandBuffers[]{ commandBuffer };
-	VkSemaphore waitSemaphores[] = { imageAvailableSemaphore };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 	VkSemaphore signalSemaphores[] = { renderFinishedSemaphore };
 
-	submitInfo.waitSemaphoreCount = 1;
-	submitInfo.pWaitSemaphores = waitSemaphores;
-	submitInfo.pWaitDstStageMask = waitStages;
+	submitInfo.waitSemaphoreCount = static_cast<uint32_t>(frameWaitSemaphores_.size());
+	submitInfo.pWaitSemaphores = frameWaitSemaphores_.data();
+	submitInfo.pWaitDstStageMask = frameWaitStages_.data();
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = commandBuffers;
-	submitInfo.signalSemaphoreCount = 1;
-	submitInfo.pSignalSemaphores = signalSemaphores;
+	submitInfo.signalSemaphoreCount = static_cast<uint32_t>(frameSignalSemaphores_.size());
+	submitInfo.pSignalSemaphores = frameSignalSemaphores_.data();
 
 	inFlightFence.Reset();
 
 	Check(vkQueueSubmit(device_->GraphicsQueue(), 1, &submitInfo, inFlightFence.Handle()),
 		"submit draw command buffer");
 
+	frameWaitSemaphores_.clear();
+	frameWaitValues_.clear();
+	frameWaitStages_.clear();
+	frameSignalSemaphores_.clear();
+	frameSignalValues_.clear();
+
 	VkSwapchainKHR swapChains[] = { swapChain_->Handle() };
 	VkPresentInfoKHR presentInfo = {};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -251,6 +286,7 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 	renderPassInfo.pClearValues = clearValues.data();
 
+	gpuTimer_->Begin(commandBuffer, "Rasterize");
 	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 	{
 		const auto& scene = GetScene();
@@ -280,6 +316,20 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 		}
 	}
 	vkCmdEndRenderPass(commandBuffer);
+	gpuTimer_->End(commandBuffer);
+}
+
+void Application::AddFrameWait(const TimelineSemaphore& semaphore, const uint64_t value, const VkPipelineStageFlags stages)
+{
+	frameWaitSemaphores_.push_back(semaphore.Handle());
+	frameWaitValues_.push_back(value);
+	frameWaitStages_.push_back(stages);
+}
+
+void Application::AddFrameSignal(const TimelineSemaphore& semaphore, const uint64_t value)
+{
+	frameSignalSemaphores_.push_back(semaphore.Handle());
+	frameSignalValues_.push_back(value);
 }
 
 void Application::UpdateUniformBuffer(const uint32_t imageIndex)
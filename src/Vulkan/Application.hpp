@@ -31,6 +31,7 @@ namespace Vulkan
 		const class Window& Window() const { return *window_; }
 
 		bool HasSwapChain() const { return swapChain_.operator bool(); }
+		bool IsHeadless() const { return !window_; }
 
 		void SetPhysicalDevice(VkPhysicalDevice physicalDevice);
 		void Run();
@@ -45,6 +46,8 @@ namespace Vulkan
 		const std::vector<Assets::UniformBuffer>& UniformBuffers() const { return uniformBuffers_; }
 		const class GraphicsPipeline& GraphicsPipeline() const { return *graphicsPipeline_; }
 		const class FrameBuffer& SwapChainFrameBuffer(const size_t i) const { return swapChainFramebuffers_[i]; }
+		class GpuTimer& GpuTimer() { return *gpuTimer_; }
+		const class GpuTimer& GpuTimer() const { return *gpuTimer_; }
 		
 		virtual const Assets::Scene& GetScene() const = 0;
 		virtual Assets::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const = 0;
@@ -61,6 +64,14 @@ namespace Vulkan
 		virtual void DrawFrame();
 		virtual void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 
+		// Called once the frame is recorded and its uniform buffer updated, right before it is submitted to the graphics queue.
+		virtual void OnFrameRecorded(uint32_t imageIndex) { }
+
+		// Timeline semaphore values the next frame submission waits for (at the given stages) and signals,
+		// in addition to the swapchain semaphores.
+		void AddFrameWait(const class TimelineSemaphore& semaphore, uint64_t value, VkPipelineStageFlags stages);
+		void AddFrameSignal(const class TimelineSemaphore& semaphore, uint64_t value);
+
 		virtual void OnKey(int key, int scancode, int action, int mods) { }
 		virtual void OnCursorPosition(double xpos, double ypos) { }
 		virtual void OnMouseButton(int button, int action, int mods) { }
@@ -87,10 +98,17 @@ namespace Vulkan
 		std::vector<class FrameBuffer> swapChainFramebuffers_;
 		std::unique_ptr<class CommandPool> commandPool_;
 		std::unique_ptr<class CommandBuffers> commandBuffers_;
+		std::unique_ptr<class GpuTimer> gpuTimer_;
 		std::vector<class Semaphore> imageAvailableSemaphores_;
 		std::vector<class Semaphore> renderFinishedSemaphores_;
 		std::vector<class Fence> inFlightFences_;
 
+		std::vector<VkSemaphore> frameWaitSemaphores_;
+		std::vector<uint64_t> frameWaitValues_;
+		std::vector<VkPipelineStageFlags> frameWaitStages_;
+		std::vector<VkSemaphore> frameSignalSemaphores_;
+		std::vector<uint64_t> frameSignalValues_;
+
 		size_t currentFrame_{};
 	};
 
@@ -1,16 +1,21 @@
 #include "Buffer.hpp"
+#include "Device.hpp"
 #include "SingleTimeCommands.hpp"
 
 namespace Vulkan {
 
-Buffer::Buffer(const class Device& device, const size_t size, const VkBufferUsageFlags usage) :
+Buffer::Buffer(const class Device& device, const size_t size, const VkBufferUsageFlags usage, const VkSharingMode sharingMode) :
 	device_(device)
 {
+	const bool isConcurrent = sharingMode == VK_SHARING_MODE_CONCURRENT;
+
 	VkBufferCreateInfo bufferInfo = {};
 	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 	bufferInfo.size = size;
 	bufferInfo.usage = usage;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	bufferInfo.sharingMode = sharingMode;
+	bufferInfo.queueFamilyIndexCount = isConcurrent ? static_cast<uint32_t>(device.SharedFamilyIndices().size()) : 0;
+	bufferInfo.pQueueFamilyIndices = isConcurrent ? device.SharedFamilyIndices().data() : nullptr;
 
 	Check(vkCreateBuffer(device.Handle(), &bufferInfo, nullptr, &buffer_),
 		"create buffer");
@@ -15,7 +15,8 @@ namespace Vulkan
 
 		VULKAN_NON_COPIABLE(Buffer)
 
-		Buffer(const Device& device, size_t size, VkBufferUsageFlags usage);
+		// Concurrent buffers are shared between the graphics and the compute queue families (see Device::SharedFamilyIndices).
+		Buffer(const Device& device, size_t size, VkBufferUsageFlags usage, VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
 		~Buffer();
 
 		const class Device& Device() const { return device_; }
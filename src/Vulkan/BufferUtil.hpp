@@ -4,6 +4,7 @@
 #include "CommandPool.hpp"
 #include "Device.hpp"
 #include "DeviceMemory.hpp"
+#include "SingleTimeCommands.hpp"
 #include <cstring>
 #include <memory>
 #include <string>
@@ -26,7 +27,12 @@ namespace Vulkan
 			VkBufferUsageFlags usage,
 			const std::vector<T>& content,
 			std::unique_ptr<Buffer>& buffer,
-			std::unique_ptr<DeviceMemory>& memory);
+			std::unique_ptr<DeviceMemory>& memory,
+			VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
+
+		// Synchronous read back of a buffer written by shaders (created with VK_BUFFER_USAGE_TRANSFER_SRC_BIT).
+		template <class T>
+		static std::vector<T> CopyToHost(CommandPool& commandPool, const Buffer& srcBuffer, size_t count);
 	};
 
 	template <class T>
@@ -58,7 +64,8 @@ namespace Vulkan
 		const VkBufferUsageFlags usage, 
 		const std::vector<T>& content,
 		std::unique_ptr<Buffer>& buffer,
-		std::unique_ptr<DeviceMemory>& memory)
+		std::unique_ptr<DeviceMemory>& memory,
+		const VkSharingMode sharingMode)
 	{
 		const auto& device = commandPool.Device();
 		const auto& debugUtils = device.DebugUtils();
@@ -67,7 +74,7 @@ namespace Vulkan
 			? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT
 			: 0;
 
-		buffer.reset(new Buffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage));
+		buffer.reset(new Buffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage, sharingMode));
 		memory.reset(new DeviceMemory(buffer->AllocateMemory(allocateFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 		debugUtils.SetObjectName(buffer->Handle(), (name + std::string(" Buffer")).c_str());
@@ -75,4 +82,47 @@ namespace Vulkan
 
 		CopyFromStagingBuffer(commandPool, *buffer, content);
 	}
+
+	template <class T>
+	std::vector<T> BufferUtil::CopyToHost(CommandPool& commandPool, const Buffer& srcBuffer, const size_t count)
+	{
+		const auto& device = commandPool.Device();
+		const auto contentSize = sizeof(T) * count;
+
+		// Create a temporary host-visible staging buffer.
+		auto stagingBuffer = std::make_unique<Buffer>(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+		auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
+		{
+			VkMemoryBarrier memoryBarrier = {};
+			memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+			VkBufferCopy copyRegion = {};
+			copyRegion.size = contentSize;
+
+			vkCmdCopyBuffer(commandBuffer, srcBuffer.Handle(), stagingBuffer->Handle(), 1, &copyRegion);
+
+			memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		});
+
+		// Copy the staging buffer into host memory.
+		std::vector<T> content(count);
+
+		const auto data = stagingBufferMemory.Map(0, contentSize);
+		std::memcpy(content.data(), data, contentSize);
+		stagingBufferMemory.Unmap();
+
+		// Delete the buffer before the memory
+		stagingBuffer.reset();
+
+		return content;
+	}
 }
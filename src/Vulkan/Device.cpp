@@ -35,13 +35,15 @@ namespace
 
 Device::Device(
 	VkPhysicalDevice physicalDevice, 
-	const class Surface& surface, 
+	const class Instance& instance,
+	const class Surface* const surface, 
 	const std::vector<const char*>& requiredExtensions,
 	const VkPhysicalDeviceFeatures& deviceFeatures,
 	const void* nextDeviceFeatures) :
 	physicalDevice_(physicalDevice),
+	instance_(instance),
 	surface_(surface),
-	debugUtils_(surface.Instance().Handle())
+	debugUtils_(instance.Handle())
 {
 	CheckRequiredExtensions(physicalDevice, requiredExtensions);
 
@@ -55,12 +57,13 @@ Device::Device(
 	//and causes problems with RADV (see https://github.com/NVIDIA/Q2RTX/issues/147).
 	//const auto transferFamily = FindQueue(queueFamilies, "transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
 
-	// Find the presentation queue (usually the same as graphics queue).
-	const auto presentFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
+	// Find the presentation queue (usually the same as graphics queue). Without a surface nothing is presented,
+	// so the graphics queue stands in for it.
+	const auto presentFamily = surface == nullptr ? graphicsFamily : std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
 	{
 		VkBool32 presentSupport = false;
 		const uint32_t i = static_cast<uint32_t>(&*queueFamilies.cbegin() - &queueFamily);
-		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface.Handle(), &presentSupport);
+		vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface->Handle(), &presentSupport);
 		return queueFamily.queueCount > 0 && presentSupport;
 	});
 
@@ -74,6 +77,9 @@ Device::Device(
 	presentFamilyIndex_ = static_cast<uint32_t>(presentFamily - queueFamilies.begin());
 	//transferFamilyIndex_ = static_cast<uint32_t>(transferFamily - queueFamilies.begin());
 
+	// The compute queue family is never the graphics one.
+	sharedFamilyIndices_ = { graphicsFamilyIndex_, computeFamilyIndex_ };
+
 	// Queues can be the same
 	const std::set<uint32_t> uniqueQueueFamilies =
 	{
@@ -105,8 +111,8 @@ Device::Device(
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledLayerCount = static_cast<uint32_t>(surface_.Instance().ValidationLayers().size());
-	createInfo.ppEnabledLayerNames = surface_.Instance().ValidationLayers().data();
+	createInfo.enabledLayerCount = static_cast<uint32_t>(instance_.ValidationLayers().size());
+	createInfo.ppEnabledLayerNames = instance_.ValidationLayers().data();
 	createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
 	createInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
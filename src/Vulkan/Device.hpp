@@ -6,6 +6,7 @@
 
 namespace Vulkan
 {
+	class Instance;
 	class Surface;
 
 	class Device final
@@ -16,7 +17,8 @@ namespace Vulkan
 
 		Device(
 			VkPhysicalDevice physicalDevice, 
-			const Surface& surface, 
+			const Instance& instance,
+			const Surface* surface, 
 			const std::vector<const char*>& requiredExtensionsconst,
 			const VkPhysicalDeviceFeatures& deviceFeatures,
 			const void* nextDeviceFeatures);
@@ -24,7 +26,9 @@ namespace Vulkan
 		~Device();
 
 		VkPhysicalDevice PhysicalDevice() const { return physicalDevice_; }
-		const class Surface& Surface() const { return surface_; }
+		const class Instance& Instance() const { return instance_; }
+		const class Surface& Surface() const { return *surface_; }
+		bool HasSurface() const { return surface_ != nullptr; }
 
 		const class DebugUtils& DebugUtils() const { return debugUtils_; }
 
@@ -38,6 +42,9 @@ namespace Vulkan
 		VkQueue PresentQueue() const { return presentQueue_; }
 		//VkQueue TransferQueue() const { return transferQueue_; }
 
+		// Queue families of the concurrent buffers and images, those the light probe bake on the compute queue accesses.
+		const std::vector<uint32_t>& SharedFamilyIndices() const { return sharedFamilyIndices_; }
+
 		void WaitIdle() const;
 
 	private:
@@ -45,7 +52,8 @@ namespace Vulkan
 		void CheckRequiredExtensions(VkPhysicalDevice physicalDevice, const std::vector<const char*>& requiredExtensions) const;
 
 		const VkPhysicalDevice physicalDevice_;
-		const class Surface& surface_;
+		const class Instance& instance_;
+		const class Surface* surface_;
 
 		VULKAN_HANDLE(VkDevice, device_)
 
@@ -55,6 +63,7 @@ namespace Vulkan
 		uint32_t computeFamilyIndex_{};
 		uint32_t presentFamilyIndex_{};
 		//uint32_t transferFamilyIndex_{};
+		std::vector<uint32_t> sharedFamilyIndices_;
 
 		VkQueue graphicsQueue_{};
 		VkQueue computeQueue_{};
@@ -0,0 +1,150 @@
+#include "GpuTimer.hpp"
+#include "Device.hpp"
+#include "Enumerate.hpp"
+#include "QueryPool.hpp"
+#include <cstring>
+#include <numeric>
+
+namespace Vulkan {
+
+GpuTimer::GpuTimer(const class Device& device, const uint32_t queueFamilyIndex, const size_t frameCount) :
+	framePasses_(frameCount)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	const auto queueFamilies = GetEnumerateVector(device.PhysicalDevice(), vkGetPhysicalDeviceQueueFamilyProperties);
+	const auto validBits = queueFamilies[queueFamilyIndex].timestampValidBits;
+
+	if (validBits == 0)
+	{
+		return;
+	}
+
+	timestampPeriod_ = properties.limits.timestampPeriod;
+	timestampMask_ = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+
+	queryPool_.reset(new QueryPool(device, VK_QUERY_TYPE_TIMESTAMP, static_cast<uint32_t>(frameCount) * MaxPassesPerFrame * 2));
+}
+
+GpuTimer::~GpuTimer()
+{
+	queryPool_.reset();
+}
+
+void GpuTimer::BeginFrame(VkCommandBuffer commandBuffer, const uint32_t frameIndex)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	ReadBack(frameIndex);
+
+	framePasses_[frameIndex].clear();
+	openPasses_.clear();
+	frameIndex_ = frameIndex;
+	nextQuery_ = frameIndex * MaxPassesPerFrame * 2;
+
+	queryPool_->Reset(commandBuffer, nextQuery_, MaxPassesPerFrame * 2);
+}
+
+void GpuTimer::Begin(VkCommandBuffer commandBuffer, const char* const name)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	auto& passes = framePasses_[frameIndex_];
+
+	// Passes beyond the query range of the frame are not timed.
+	if (passes.size() == MaxPassesPerFrame)
+	{
+		openPasses_.push_back(MaxPassesPerFrame);
+		return;
+	}
+
+	// Both timestamps wait for the previous commands to complete, so that the passes do not overlap in the figures.
+	openPasses_.push_back(passes.size());
+	passes.push_back({ name, nextQuery_ });
+	queryPool_->WriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, nextQuery_);
+	nextQuery_ += 2;
+}
+
+void GpuTimer::End(VkCommandBuffer commandBuffer)
+{
+	if (!IsSupported())
+	{
+		return;
+	}
+
+	const auto pass = openPasses_.back();
+	openPasses_.pop_back();
+
+	if (pass != MaxPassesPerFrame)
+	{
+		queryPool_->WriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, framePasses_[frameIndex_][pass].Query + 1);
+	}
+}
+
+void GpuTimer::ReadBack(const uint32_t frameIndex)
+{
+	const auto& passes = framePasses_[frameIndex];
+
+	if (passes.empty())
+	{
+		return;
+	}
+
+	const uint32_t firstQuery = frameIndex * MaxPassesPerFrame * 2;
+
+	if (!queryPool_->GetResults(firstQuery, static_cast<uint32_t>(passes.size()) * 2, timestamps_))
+	{
+		return;
+	}
+
+	passTimes_.clear();
+
+	for (const auto& pass : passes)
+	{
+		const auto begin = timestamps_[pass.Query - firstQuery];
+		const auto end = timestamps_[pass.Query - firstQuery + 1];
+		const auto milliseconds = static_cast<float>(static_cast<double>((end - begin) & timestampMask_) * timestampPeriod_ / 1000000.0);
+
+		passTimes_.push_back({ pass.Name, milliseconds, Average(pass.Name, milliseconds) });
+	}
+}
+
+float GpuTimer::Average(const char* const name, const float milliseconds)
+{
+	auto history = histories_.begin();
+
+	while (history != histories_.end() && std::strcmp(history->Name, name) != 0)
+	{
+		++history;
+	}
+
+	if (history == histories_.end())
+	{
+		histories_.push_back({ name, {}, 0 });
+		history = histories_.end() - 1;
+	}
+
+	// Rolling window over the last frames.
+	if (history->Milliseconds.size() < AverageFrameCount)
+	{
+		history->Milliseconds.push_back(milliseconds);
+	}
+	else
+	{
+		history->Milliseconds[history->Next] = milliseconds;
+		history->Next = (history->Next + 1) % AverageFrameCount;
+	}
+
+	const float sum = std::accumulate(history->Milliseconds.begin(), history->Milliseconds.end(), 0.0f);
+
+	return sum / static_cast<float>(history->Milliseconds.size());
+}
+
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+	class QueryPool;
+
+	// GPU time of a pass in the last frame read back, and its average over the last frames it was recorded in.
+	struct GpuPassTime final
+	{
+		const char* Name;
+		float Milliseconds;
+		float AverageMilliseconds;
+	};
+
+	// Times the passes of each frame on the GPU, with a begin and an end timestamp per pass. Each swapchain image has its own
+	// range of queries, read back when the image is recorded again, once its previous frame is expected to be complete
+	// (a frame that is still not available is simply skipped). Does nothing on queues without timestamp support.
+	class GpuTimer final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(GpuTimer)
+
+		GpuTimer(const Device& device, uint32_t queueFamilyIndex, size_t frameCount);
+		~GpuTimer();
+
+		bool IsSupported() const { return queryPool_.operator bool(); }
+
+		// Passes of the last frame read back, in recording order.
+		const std::vector<GpuPassTime>& PassTimes() const { return passTimes_; }
+
+		// Reads back the previous frame recorded for this image, and resets its queries.
+		void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Pass names are expected to be string literals. Passes can be nested.
+		void Begin(VkCommandBuffer commandBuffer, const char* name);
+		void End(VkCommandBuffer commandBuffer);
+
+	private:
+
+		static constexpr uint32_t MaxPassesPerFrame = 16;
+		static constexpr size_t AverageFrameCount = 64;
+
+		struct Pass
+		{
+			const char* Name;
+			uint32_t Query;
+		};
+
+		struct PassHistory
+		{
+			const char* Name;
+			std::vector<float> Milliseconds;
+			size_t Next;
+		};
+
+		void ReadBack(uint32_t frameIndex);
+		float Average(const char* name, float milliseconds);
+
+		std::unique_ptr<QueryPool> queryPool_;
+		double timestampPeriod_{};
+		uint64_t timestampMask_{};
+
+		std::vector<std::vector<Pass>> framePasses_;
+		std::vector<size_t> openPasses_;
+		uint32_t frameIndex_{};
+		uint32_t nextQuery_{};
+
+		std::vector<PassHistory> histories_;
+		std::vector<GpuPassTime> passTimes_;
+		std::vector<uint64_t> timestamps_;
+	};
+
+}
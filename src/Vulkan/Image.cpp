@@ -18,8 +18,33 @@ Image::Image(
 	const VkFormat format,
 	const VkImageTiling tiling,
 	const VkImageUsageFlags usage) :
+	Image(device, extent, 1, format, tiling, usage)
+{
+}
+
+Image::Image(
+	const class Device& device,
+	const VkExtent2D extent,
+	const uint32_t arrayLayers,
+	const VkFormat format,
+	const VkImageTiling tiling,
+	const VkImageUsageFlags usage) :
+	Image(device, extent, arrayLayers, format, tiling, usage, 0)
+{
+}
+
+Image::Image(
+	const class Device& device,
+	const VkExtent2D extent,
+	const uint32_t arrayLayers,
+	const VkFormat format,
+	const VkImageTiling tiling,
+	const VkImageUsageFlags usage,
+	const VkImageCreateFlags flags,
+	const VkSharingMode sharingMode) :
 	device_(device),
 	extent_(extent),
+	arrayLayers_(arrayLayers),
 	format_(format),
 	imageLayout_(VK_IMAGE_LAYOUT_UNDEFINED)
 {
@@ -30,14 +55,16 @@ Image::Image(
 	imageInfo.extent.height = extent.height;
 	imageInfo.extent.depth = 1;
 	imageInfo.mipLevels = 1;
-	imageInfo.arrayLayers = 1;
+	imageInfo.arrayLayers = arrayLayers;
 	imageInfo.format = format;
 	imageInfo.tiling = tiling;
 	imageInfo.initialLayout = imageLayout_;
 	imageInfo.usage = usage;
-	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.sharingMode = sharingMode;
+	imageInfo.queueFamilyIndexCount = sharingMode == VK_SHARING_MODE_CONCURRENT ? static_cast<uint32_t>(device.SharedFamilyIndices().size()) : 0;
+	imageInfo.pQueueFamilyIndices = sharingMode == VK_SHARING_MODE_CONCURRENT ? device.SharedFamilyIndices().data() : nullptr;
 	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-	imageInfo.flags = 0; // Optional
+	imageInfo.flags = flags;
 
 	Check(vkCreateImage(device.Handle(), &imageInfo, nullptr, &image_),
 		"create image");
@@ -46,6 +73,7 @@ Image::Image(
 Image::Image(Image&& other) noexcept :
 	device_(other.device_),
 	extent_(other.extent_),
+	arrayLayers_(other.arrayLayers_),
 	format_(other.format_),
 	imageLayout_(other.imageLayout_),
 	image_(other.image_)
@@ -137,6 +165,14 @@ void Image::TransitionImageLayout(CommandPool& commandPool, VkImageLayout newLay
 			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
 			destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
 		}
+		else if (imageLayout_ == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_GENERAL)
+		{
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+
+			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+			destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		}
 		else 
 		{
 			Throw(std::invalid_argument("unsupported layout transition"));
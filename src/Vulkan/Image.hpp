@@ -19,12 +19,17 @@ namespace Vulkan
 
 		Image(const Device& device, VkExtent2D extent, VkFormat format);
 		Image(const Device& device, VkExtent2D extent, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage);
+		Image(const Device& device, VkExtent2D extent, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage);
+		// Concurrent images are shared between the graphics and the compute queue families (see Device::SharedFamilyIndices).
+		Image(const Device& device, VkExtent2D extent, uint32_t arrayLayers, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkImageCreateFlags flags,
+			VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
 		Image(Image&& other) noexcept;
 		~Image();
 
 		const class Device& Device() const { return device_; }
 		VkExtent2D Extent() const { return extent_; }
 		VkFormat Format() const { return format_; }
+		uint32_t ArrayLayers() const { return arrayLayers_; }
 
 		DeviceMemory AllocateMemory(VkMemoryPropertyFlags properties) const;
 		VkMemoryRequirements GetMemoryRequirements() const;
@@ -36,6 +41,7 @@ namespace Vulkan
 
 		const class Device& device_;
 		const VkExtent2D extent_;
+		const uint32_t arrayLayers_;
 		const VkFormat format_;
 		VkImageLayout imageLayout_;
 
@@ -4,14 +4,33 @@
 namespace Vulkan {
 
 ImageView::ImageView(const class Device& device, const VkImage image, const VkFormat format, const VkImageAspectFlags aspectFlags) :
+	ImageView(device, image, format, aspectFlags, VK_IMAGE_VIEW_TYPE_2D, 1)
+{
+}
+
+ImageView::ImageView(
+	const class Device& device, 
+	const VkImage image, 
+	const VkFormat format, 
+	const VkImageAspectFlags aspectFlags, 
+	const VkImageViewType viewType, 
+	const uint32_t layerCount,
+	const VkImageUsageFlags usage) :
 	device_(device),
 	image_(image),
 	format_(format)
 {
+	// Optionally restrict the view to a subset of the image usage (e.g. a view in a format that cannot be used for storage).
+	VkImageViewUsageCreateInfo usageInfo = {};
+	usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+	usageInfo.pNext = nullptr;
+	usageInfo.usage = usage;
+
 	VkImageViewCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	createInfo.pNext = usage != 0 ? &usageInfo : nullptr;
 	createInfo.image = image;
-	createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	createInfo.viewType = viewType;
 	createInfo.format = format;
 	createInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
 	createInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
@@ -21,7 +40,7 @@ ImageView::ImageView(const class Device& device, const VkImage image, const VkFo
 	createInfo.subresourceRange.baseMipLevel = 0;
 	createInfo.subresourceRange.levelCount = 1;
 	createInfo.subresourceRange.baseArrayLayer = 0;
-	createInfo.subresourceRange.layerCount = 1;
+	createInfo.subresourceRange.layerCount = layerCount;
 
 	Check(vkCreateImageView(device_.Handle(), &createInfo, nullptr, &imageView_),
 		"create image view");
@@ -13,6 +13,7 @@ namespace Vulkan
 		VULKAN_NON_COPIABLE(ImageView)
 
 		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags);
+		explicit ImageView(const Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, VkImageViewType viewType, uint32_t layerCount, VkImageUsageFlags usage = 0);
 		~ImageView();
 
 		const class Device& Device() const { return device_; }
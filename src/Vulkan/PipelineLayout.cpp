@@ -4,7 +4,7 @@
 
 namespace Vulkan {
 
-PipelineLayout::PipelineLayout(const Device & device, const DescriptorSetLayout& descriptorSetLayout) :
+PipelineLayout::PipelineLayout(const Device & device, const DescriptorSetLayout& descriptorSetLayout, const VkShaderStageFlags pushConstantStages) :
 	device_(device)
 {
 	VkDescriptorSetLayout descriptorSetLayouts[] = { descriptorSetLayout.Handle() };
@@ -19,7 +19,7 @@ PipelineLayout::PipelineLayout(const Device & device, const DescriptorSetLayout&
 
 
 	VkPushConstantRange pushConstantRange{};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_RAYGEN_BIT_KHR;
+	pushConstantRange.stageFlags = pushConstantStages;
 	pushConstantRange.offset = 0;
 	pushConstantRange.size = sizeof(MyPushConstants);
 
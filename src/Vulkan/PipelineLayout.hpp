@@ -13,7 +13,7 @@ namespace Vulkan
 
 		VULKAN_NON_COPIABLE(PipelineLayout)
 
-		PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout);
+		PipelineLayout(const Device& device, const DescriptorSetLayout& descriptorSetLayout, VkShaderStageFlags pushConstantStages = VK_SHADER_STAGE_RAYGEN_BIT_KHR);
 		~PipelineLayout();
 
 	private:
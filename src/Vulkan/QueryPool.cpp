@@ -0,0 +1,57 @@
+#include "QueryPool.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+QueryPool::QueryPool(const class Device& device, const VkQueryType queryType, const uint32_t queryCount) :
+	device_(device),
+	queryCount_(queryCount)
+{
+	VkQueryPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = queryType;
+	poolInfo.queryCount = queryCount;
+
+	Check(vkCreateQueryPool(device.Handle(), &poolInfo, nullptr, &queryPool_),
+		"create query pool");
+}
+
+QueryPool::~QueryPool()
+{
+	if (queryPool_ != nullptr)
+	{
+		vkDestroyQueryPool(device_.Handle(), queryPool_, nullptr);
+		queryPool_ = nullptr;
+	}
+}
+
+void QueryPool::Reset(VkCommandBuffer commandBuffer, const uint32_t firstQuery, const uint32_t queryCount)
+{
+	vkCmdResetQueryPool(commandBuffer, queryPool_, firstQuery, queryCount);
+}
+
+void QueryPool::WriteTimestamp(VkCommandBuffer commandBuffer, const VkPipelineStageFlagBits pipelineStage, const uint32_t query)
+{
+	vkCmdWriteTimestamp(commandBuffer, pipelineStage, queryPool_, query);
+}
+
+bool QueryPool::GetResults(const uint32_t firstQuery, const uint32_t queryCount, std::vector<uint64_t>& results) const
+{
+	results.resize(queryCount);
+
+	const auto result = vkGetQueryPoolResults(
+		device_.Handle(), queryPool_, firstQuery, queryCount,
+		results.size() * sizeof(uint64_t), results.data(), sizeof(uint64_t),
+		VK_QUERY_RESULT_64_BIT);
+
+	if (result == VK_NOT_READY)
+	{
+		return false;
+	}
+
+	Check(result, "get query pool results");
+
+	return true;
+}
+
+}
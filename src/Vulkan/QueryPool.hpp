@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Vulkan.hpp"
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+
+	class QueryPool final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(QueryPool)
+
+		QueryPool(const Device& device, VkQueryType queryType, uint32_t queryCount);
+		~QueryPool();
+
+		const class Device& Device() const { return device_; }
+		uint32_t QueryCount() const { return queryCount_; }
+
+		void Reset(VkCommandBuffer commandBuffer, uint32_t firstQuery, uint32_t queryCount);
+		void WriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, uint32_t query);
+
+		// Copies the 64-bit results of the given queries without waiting for them, returns false if they are not all available yet.
+		bool GetResults(uint32_t firstQuery, uint32_t queryCount, std::vector<uint64_t>& results) const;
+
+	private:
+
+		const class Device& device_;
+		const uint32_t queryCount_;
+
+		VULKAN_HANDLE(VkQueryPool, queryPool_)
+	};
+
+}
@@ -1,31 +1,83 @@
 #include "Application.hpp"
 #include "BottomLevelAccelerationStructure.hpp"
 #include "DeviceProcedures.hpp"
+#include "GBufferPipeline.hpp"
 #include "RayTracingPipeline.hpp"
 #include "ShaderBindingTable.hpp"
 #include "TopLevelAccelerationStructure.hpp"
 #include "LightProbeRTPipeline.hpp"
 #include "LightProbe.hpp"
+#include "LightProbeAtlas.hpp"
+#include "LightProbeCache.hpp"
+#include "LightProbeCascades.hpp"
+#include "LightProbeGlossyPipeline.hpp"
+#include "LightProbePlacement.hpp"
+#include "LightProbeRelocationPipeline.hpp"
+#include "LightProbeResidency.hpp"
+#include "LightProbeSHPipeline.hpp"
+#include "ProbeBakeScheduler.hpp"
+#include "ProbeGatherPipeline.hpp"
+#include "ProbeTransfer.hpp"
 #include "Assets/Model.hpp"
 #include "Assets/Scene.hpp"
+#include "Assets/UniformBuffer.hpp"
 #include "Utilities/Glm.hpp"
 #include "Vulkan/Buffer.hpp"
 #include "Vulkan/BufferUtil.hpp"
+#include "Vulkan/CommandBuffers.hpp"
+#include "Vulkan/CommandPool.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/Enumerate.hpp"
+#include "Vulkan/Fence.hpp"
+#include "Vulkan/GpuTimer.hpp"
 #include "Vulkan/Image.hpp"
 #include "Vulkan/ImageMemoryBarrier.hpp"
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/SingleTimeCommands.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include "Vulkan/TimelineSemaphore.hpp"
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstring>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <utility>
 
+#undef MemoryBarrier
 
 namespace Vulkan::RayTracing {
 
 namespace
 {
+	// Inline ray queries are an optional backend (see setRayQuery), only enabled on the devices supporting them.
+	bool SupportsRayQuery(const VkPhysicalDevice physicalDevice)
+	{
+		const auto extensions = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
+		const auto hasExtension = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension)
+		{
+			return strcmp(extension.extensionName, VK_KHR_RAY_QUERY_EXTENSION_NAME) == 0;
+		});
+
+		if (!hasExtension)
+		{
+			return false;
+		}
+
+		VkPhysicalDeviceRayQueryFeaturesKHR rayQueryFeatures = {};
+		rayQueryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR;
+
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &rayQueryFeatures;
+
+		vkGetPhysicalDeviceFeatures2(physicalDevice, &features);
+
+		return rayQueryFeatures.rayQuery;
+	}
+
 	template <class TAccelerationStructure>
 	VkAccelerationStructureBuildSizesInfoKHR GetTotalRequirements(const std::vector<TAccelerationStructure>& accelerationStructures)
 	{
@@ -40,6 +92,78 @@ namespace
 
 		return total;
 	}
+
+	// Matches the push constants of RayTracing.rgen (the render mode is a specialization constant).
+	struct RayTracingConstants
+	{
+		uint32_t CurrentProbeIndex;
+	};
+
+	// Matches the push constants of ProbeGather.comp.
+	struct ProbeGatherConstants
+	{
+		uint32_t ProbeShadingMode;
+	};
+
+	// Matches the push constants of LightProbe.rgen.
+	struct LightProbeConstants
+	{
+		uint32_t FirstProbe;
+		uint32_t SampleOffset;
+		uint32_t SampleCount;
+		float Hysteresis;
+	};
+
+	// Matches the push constants of LightProbeRelocation.rgen.
+	struct LightProbeRelocationConstants
+	{
+		uint32_t Iteration;
+		uint32_t IsRelocating;
+		uint32_t RayCount;
+		float MaxOffset;
+	};
+
+	void ProbeTransferBarrier(
+		VkCommandBuffer commandBuffer,
+		const VkPipelineStageFlags srcStage, const VkAccessFlags srcAccess,
+		const VkPipelineStageFlags dstStage, const VkAccessFlags dstAccess)
+	{
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = nullptr;
+		memoryBarrier.srcAccessMask = srcAccess;
+		memoryBarrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void ProbeMemoryBarrier(VkCommandBuffer commandBuffer, const VkPipelineStageFlags srcStage, const VkPipelineStageFlags dstStage)
+	{
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = nullptr;
+		memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void ProbeMemoryBarrier(VkCommandBuffer commandBuffer)
+	{
+		// The probe images are written by the bake and read by the main trace (and by the next bake batch), all of which
+		// live in the ray tracing shader stage, or in the compute one with the ray query backend.
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = nullptr;
+		memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(
+			commandBuffer,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
 }
 
 Application::Application(const WindowConfig& windowConfig, const VkPresentModeKHR presentMode, const bool enableValidationLayers) :
@@ -54,10 +178,107 @@ Application::~Application()
 	DeleteAccelerationStructures();
 	DeleteProbeTextureImage();
 
+	probeReadSemaphore_.reset();
+	probeBakeSemaphore_.reset();
+	probeBakeCommandPool_.reset();
 	rayTracingProperties_.reset();
 	deviceProcedures_.reset();
 }
 
+float Application::getProbeBakeProgress() const
+{
+	return probeBakeScheduler ? probeBakeScheduler->Progress() : 0.0f;
+}
+
+bool Application::isProbeBakeComplete() const
+{
+	return probeBakeScheduler && probeBakeScheduler->IsComplete();
+}
+
+std::vector<GpuPassTime> Application::GpuPassTimes() const
+{
+	auto passTimes = GpuTimer().PassTimes();
+
+	if (hasProbeBakeTimes_)
+	{
+		const auto& probeBakeTimes = probeBakeGpuTimer_->PassTimes();
+		passTimes.insert(passTimes.begin(), probeBakeTimes.begin(), probeBakeTimes.end());
+	}
+
+	return passTimes;
+}
+
+void Application::BakeProbes()
+{
+	// The cache is where the baked probes go: there is none for the scrolling cascades nor for paged probes.
+	if (!lightProbeCache)
+	{
+		Throw(std::runtime_error("cannot bake light probes without a probe cache directory, nor with probe cascades or a resident probe count"));
+	}
+
+	// A single uniform buffer stands in for the swapchain ones, the probe rays do not depend on the camera.
+	std::vector<Assets::UniformBuffer> uniformBuffers;
+	uniformBuffers.emplace_back(Device());
+	uniformBuffers[0].SetValue(GetUniformBufferObject({ 1, 1 }));
+
+	CreateLightProbeRTPipeline(uniformBuffers);
+
+	CommandBuffers commandBuffers(*probeBakeCommandPool_, 1);
+	Fence fence(Device(), false);
+
+	// Bake from scratch, even if the probes have just been loaded from the cache.
+	probeBakeScheduler->Reset();
+
+	std::cout << "- baking " << probeBakeScheduler->ProbeCount() << " light probes" << std::endl;
+
+	const auto timer = std::chrono::high_resolution_clock::now();
+	uint32_t submissionCount = 0;
+	uint32_t reportedProgress = 0;
+
+	while (!probeBakeScheduler->IsComplete())
+	{
+		const auto commandBuffer = commandBuffers.Begin(0);
+		Render_LightProbe(commandBuffer, 0);
+		commandBuffers.End(0);
+
+		VkCommandBuffer submitCommandBuffers[] = { commandBuffer };
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = submitCommandBuffers;
+
+		fence.Reset();
+
+		Check(vkQueueSubmit(Device().ComputeQueue(), 1, &submitInfo, fence.Handle()),
+			"submit light probe bake command buffer");
+
+		// The next batches depend on the active texel count of this one.
+		fence.Wait(std::numeric_limits<uint64_t>::max());
+		++submissionCount;
+
+		const auto progress = static_cast<uint32_t>(probeBakeScheduler->Progress() * 10.0f) * 10;
+
+		if (progress != reportedProgress)
+		{
+			std::cout << "- baked " << progress << "%" << std::endl;
+			reportedProgress = progress;
+		}
+	}
+
+	const auto elapsed = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+	const auto probeCount = probeBakeScheduler->ProbeCount();
+	const auto rays = probeBakeScheduler->RaysDone();
+
+	DeleteLightProbeRTPipeline();
+
+	lightProbeCache->Save(CommandPool(), lightProbeCascades->Grids()[0], lightProbes, lightProbeStates, *lightProbeAtlas);
+
+	std::cout << "- baked " << probeCount << " light probes in " << elapsed << "s (" << submissionCount << " submissions, "
+		<< (probeCount != 0 ? 1000.0 * elapsed / probeCount : 0.0) << " ms per probe, " << rays / elapsed / 1e6 << " Mrays/s)" << std::endl;
+	std::cout << "- saved light probes to '" << lightProbeCache->Path() << "'" << std::endl;
+}
+
 void Application::SetPhysicalDevice(
 	VkPhysicalDevice physicalDevice,
 	std::vector<const char*>& requiredExtensions,
@@ -73,9 +294,14 @@ void Application::SetPhysicalDevice(
 	});
 
 	// Required device features.
+	VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
+	timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+	timelineSemaphoreFeatures.pNext = nextDeviceFeatures;
+	timelineSemaphoreFeatures.timelineSemaphore = true;
+
 	VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeatures = {};
 	bufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
-	bufferDeviceAddressFeatures.pNext = nextDeviceFeatures;
+	bufferDeviceAddressFeatures.pNext = &timelineSemaphoreFeatures;
 	bufferDeviceAddressFeatures.bufferDeviceAddress = true;
 
 	VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures = {};
@@ -94,7 +320,20 @@ void Application::SetPhysicalDevice(
 	rayTracingFeatures.pNext = &accelerationStructureFeatures;
 	rayTracingFeatures.rayTracingPipeline = true;
 
-	Vulkan::Application::SetPhysicalDevice(physicalDevice, requiredExtensions, deviceFeatures, &rayTracingFeatures);
+	// Optional device features.
+	hasRayQuery_ = SupportsRayQuery(physicalDevice);
+
+	VkPhysicalDeviceRayQueryFeaturesKHR rayQueryFeatures = {};
+	rayQueryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_QUERY_FEATURES_KHR;
+	rayQueryFeatures.pNext = &rayTracingFeatures;
+	rayQueryFeatures.rayQuery = true;
+
+	if (hasRayQuery_)
+	{
+		requiredExtensions.push_back(VK_KHR_RAY_QUERY_EXTENSION_NAME);
+	}
+
+	Vulkan::Application::SetPhysicalDevice(physicalDevice, requiredExtensions, deviceFeatures, hasRayQuery_ ? static_cast<void*>(&rayQueryFeatures) : &rayTracingFeatures);
 }
 
 void Application::OnDeviceSet()
@@ -103,6 +342,10 @@ void Application::OnDeviceSet()
 
 	deviceProcedures_.reset(new DeviceProcedures(Device()));
 	rayTracingProperties_.reset(new RayTracingProperties(Device()));
+
+	probeBakeCommandPool_.reset(new class CommandPool(Device(), Device().ComputeFamilyIndex(), true));
+	probeBakeSemaphore_.reset(new TimelineSemaphore(Device(), 0));
+	probeReadSemaphore_.reset(new TimelineSemaphore(Device(), 0));
 }
 
  void Application::CreateAccelerationStructures()
@@ -120,8 +363,13 @@ void Application::OnDeviceSet()
 	bottomScratchBuffer_.reset();
 	bottomScratchBufferMemory_.reset();
 
+	// The scene changed, the probes have to be placed and baked again.
+	DeleteProbeTextureImage();
+	CreateProbeTextureImage();
+
 	const auto elapsed = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
 	std::cout << "- built acceleration structures in " << elapsed << "s" << std::endl;
+	std::cout << "- sampling " << GetScene().EmitterCount() << " emissive triangles (power " << GetScene().EmitterPower() << ")" << std::endl;
 }
 
 void Application::DeleteAccelerationStructures()
@@ -150,9 +398,17 @@ void Application::CreateSwapChain()
 
 
 
-	rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, SwapChain(), topAs_[0], *accumulationImageView_, *outputImageView_, UniformBuffers(), GetScene(),lightProbes,lightProbePosBuffer));
+	rayTracingPipeline_.reset(new RayTracingPipeline(*deviceProcedures_, SwapChain(), topAs_[0], *accumulationImageView_, *outputImageView_, *gBufferDepthImageView_, *gBufferNormalImageView_, *gBufferAlbedoImageView_, *historyImageView_, *historyDepthImageView_, *historyNormalImageView_, UniformBuffers(), GetScene(), *lightProbeAtlas, lightProbeSlotBuffer, hasRayQuery_));
+	gBufferPipeline_.reset(new GBufferPipeline(SwapChain(), DepthBuffer(), UniformBuffers(), GetScene(), *gBufferDepthImageView_, *gBufferNormalImageView_, *gBufferAlbedoImageView_));
+	probeGatherPipeline_.reset(new ProbeGatherPipeline(Device(), UniformBuffers(), *outputImageView_, *gBufferDepthImageView_, *gBufferNormalImageView_, *gBufferAlbedoImageView_, *lightProbeAtlas, lightProbeGridBuffer, lightProbeStateBuffer, lightProbeOffsetBuffer, lightProbeSHBuffer, lightProbeSlotBuffer));
 
-	const std::vector<ShaderBindingTable::Entry> rayGenPrograms = { {rayTracingPipeline_->RayGenShaderIndex(), {}} };
+	// One raygen record per render mode, in RenderMode order (see Render).
+	const std::vector<ShaderBindingTable::Entry> rayGenPrograms =
+	{
+		{rayTracingPipeline_->RayGenShaderIndex(RenderMode::PathTraced), {}},
+		{rayTracingPipeline_->RayGenShaderIndex(RenderMode::ProbeShaded), {}},
+		{rayTracingPipeline_->RayGenShaderIndex(RenderMode::ProbeTexture), {}}
+	};
 	const std::vector<ShaderBindingTable::Entry> missPrograms = { {rayTracingPipeline_->MissShaderIndex(), {}} };
 	const std::vector<ShaderBindingTable::Entry> hitGroups = { {rayTracingPipeline_->TriangleHitGroupIndex(), {}}, {rayTracingPipeline_->ProceduralHitGroupIndex(), {}} };
 
@@ -160,22 +416,30 @@ void Application::CreateSwapChain()
 
 
 
-	lightProbeRTPipeline.reset(new LightProbeRTPipeline(*deviceProcedures_, SwapChain(), topAs_[0], *accumulationImageView_, *outputImageView_, UniformBuffers(), GetScene(), lightProbes, lightProbePosBuffer));
+	probeBakeCommandBuffers_.reset(new CommandBuffers(*probeBakeCommandPool_, static_cast<uint32_t>(SwapChain().Images().size())));
+	probeBakeGpuTimer_.reset(new class GpuTimer(Device(), Device().ComputeFamilyIndex(), SwapChain().Images().size()));
+	probeBakeImageValues_.assign(SwapChain().Images().size(), 0);
 
-	const std::vector<ShaderBindingTable::Entry> rayLPGenPrograms = { {lightProbeRTPipeline->RayGenShaderIndex(), {}} };
-	const std::vector<ShaderBindingTable::Entry> missLPPrograms = { {lightProbeRTPipeline->MissShaderIndex(), {}} };
-	const std::vector<ShaderBindingTable::Entry> hitLPGroups = { {lightProbeRTPipeline->TriangleHitGroupIndex(), {}}, {lightProbeRTPipeline->ProceduralHitGroupIndex(), {}} };
+	CreateLightProbeRTPipeline(UniformBuffers());
 
-	lightProbeShaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, *lightProbeRTPipeline, *rayTracingProperties_, rayLPGenPrograms, missLPPrograms, hitLPGroups));
+	lightProbeSHPipeline.reset(new LightProbeSHPipeline(Device(), lightProbeConfig, *lightProbeAtlas, lightProbePosBuffer, lightProbeSHBuffer));
+	lightProbeGlossyPipeline.reset(new LightProbeGlossyPipeline(Device(), lightProbeConfig, *lightProbeAtlas, lightProbePosBuffer));
+	isProbeFilteringOutdated = true;
 }
 
 void Application::DeleteSwapChain()
 {
 	shaderBindingTable_.reset();
 	rayTracingPipeline_.reset();
+	gBufferPipeline_.reset();
+	probeGatherPipeline_.reset();
 
-	lightProbeShaderBindingTable_.reset();
-	lightProbeRTPipeline.reset();
+	DeleteLightProbeRTPipeline();
+	probeBakeGpuTimer_.reset();
+	probeBakeCommandBuffers_.reset();
+	probeBakeImageValues_.clear();
+	lightProbeSHPipeline.reset();
+	lightProbeGlossyPipeline.reset();
 
 	outputImageView_.reset();
 	outputImage_.reset();
@@ -183,6 +447,24 @@ void Application::DeleteSwapChain()
 	accumulationImageView_.reset();
 	accumulationImage_.reset();
 	accumulationImageMemory_.reset();
+	gBufferDepthImageView_.reset();
+	gBufferDepthImage_.reset();
+	gBufferDepthImageMemory_.reset();
+	gBufferNormalImageView_.reset();
+	gBufferNormalImage_.reset();
+	gBufferNormalImageMemory_.reset();
+	gBufferAlbedoImageView_.reset();
+	gBufferAlbedoImage_.reset();
+	gBufferAlbedoImageMemory_.reset();
+	historyImageView_.reset();
+	historyImage_.reset();
+	historyImageMemory_.reset();
+	historyDepthImageView_.reset();
+	historyDepthImage_.reset();
+	historyDepthImageMemory_.reset();
+	historyNormalImageView_.reset();
+	historyNormalImage_.reset();
+	historyNormalImageMemory_.reset();
 
 	Vulkan::Application::DeleteSwapChain();
 }
@@ -191,11 +473,72 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 {
 	const auto extent = SwapChain().Extent();
 
+	// Apply the probe transfer of a previous frame once that frame has completed, without waiting for it.
+	// This may record the next step of the transfer into this frame.
+	if (probeTransfer_ && probeReadSemaphore_->CounterValue() >= probeTransferValue_)
+	{
+		const auto transfer = std::move(probeTransfer_);
+		const auto applyTransfer = std::move(applyProbeTransfer_);
+		applyProbeTransfer_ = nullptr;
+
+		if (applyTransfer)
+		{
+			applyTransfer(commandBuffer, *transfer);
+		}
+	}
+
+	if (!probeTransfer_ && lightProbeCascades->IsScrolling())
+	{
+		ScrollProbes(commandBuffer);
+	}
+
+	// Page the probes in and out of the atlas as the camera moves, once the resident probes are baked.
+	if (!probeTransfer_ && !lightProbeResidency->IsComplete() && probeBakeScheduler->IsComplete())
+	{
+		UpdateResidency(commandBuffer);
+	}
+
+	// The path tracer does not sample the probes, its frames neither wait for the bake nor hold back the next one.
+	const auto renderMode = ShowOriginalRaytrace ? RenderMode::PathTraced : ShowLightProbeTexture ? RenderMode::ProbeTexture : RenderMode::ProbeShaded;
+
+	if (renderMode != RenderMode::PathTraced)
+	{
+		isProbeFrame_ = true;
+		probeWaitStages_ |= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
+	}
 
-	if (!isPrecomputed)
+	// The frame samples the probes of the previous bake submissions, filter what they baked before this frame's bake
+	// is recorded (see OnFrameRecorded).
+	if (renderMode != RenderMode::PathTraced && isProbeFilteringOutdated)
 	{
-		Render_LightProbe(commandBuffer, imageIndex);
-		isPrecomputed = true;
+		GpuTimer().Begin(commandBuffer, "Probe filtering");
+		Render_ProbeSH(commandBuffer);
+		Render_ProbeGlossy(commandBuffer);
+		GpuTimer().End(commandBuffer);
+		isProbeFilteringOutdated = false;
+	}
+
+	// A frame rewriting the bake inputs records no bake, the next frame bakes the new probe list.
+	if (!isProbeBakeHeld_)
+	{
+		if (!probeBakeScheduler->IsComplete())
+		{
+			RecordProbeBake(imageIndex, "Probe bake");
+			isProbeCacheOutdated = lightProbeCache && probeBakeScheduler->IsComplete();
+		}
+		else if (isProbeCacheOutdated)
+		{
+			// The last bake batch was submitted with the previous frame, the cache download waits for it to complete.
+			probeBakeSemaphore_->Wait(probeBakeValue_, std::numeric_limits<uint64_t>::max());
+			lightProbeCache->Save(CommandPool(), lightProbeCascades->Grids()[0], lightProbes, lightProbeStates, *lightProbeAtlas);
+			isProbeCacheOutdated = false;
+
+			std::cout << "- saved light probes to '" << lightProbeCache->Path() << "'" << std::endl;
+		}
+		else if (probeUpdateCount != 0)
+		{
+			RecordProbeBake(imageIndex, "Probe update");
+		}
 	}
 
 	VkDescriptorSet descriptorSets[] = { rayTracingPipeline_->DescriptorSet(imageIndex) };
@@ -214,16 +557,23 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 	ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange, 0,
 		VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
 
+	for (const auto& image : { gBufferDepthImage_.get(), gBufferNormalImage_.get(), gBufferAlbedoImage_.get() })
+	{
+		ImageMemoryBarrier::Insert(commandBuffer, image->Handle(), subresourceRange, 0,
+			VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	}
+
+	// Bind ray tracing pipeline, or the ray query compute pipeline of this frame's render mode.
+	const auto bindPoint = RayQuery ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
 
-	// Bind ray tracing pipeline.
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, rayTracingPipeline_->Handle());
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, rayTracingPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+	vkCmdBindPipeline(commandBuffer, bindPoint, RayQuery ? rayTracingPipeline_->ComputePipelineHandle(renderMode) : rayTracingPipeline_->Handle());
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, rayTracingPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
 
-	// Describe the shader binding table.
+	// Describe the shader binding table, whose raygen region is the single record of this frame's render mode.
 	VkStridedDeviceAddressRegionKHR raygenShaderBindingTable = {};
-	raygenShaderBindingTable.deviceAddress = shaderBindingTable_->RayGenDeviceAddress();
+	raygenShaderBindingTable.deviceAddress = shaderBindingTable_->RayGenDeviceAddress() + static_cast<uint32_t>(renderMode) * shaderBindingTable_->RayGenEntrySize();
 	raygenShaderBindingTable.stride = shaderBindingTable_->RayGenEntrySize();
-	raygenShaderBindingTable.size = shaderBindingTable_->RayGenSize();
+	raygenShaderBindingTable.size = shaderBindingTable_->RayGenEntrySize();
 
 	VkStridedDeviceAddressRegionKHR missShaderBindingTable = {};
 	missShaderBindingTable.deviceAddress = shaderBindingTable_->MissDeviceAddress();
@@ -237,25 +587,82 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 
 	VkStridedDeviceAddressRegionKHR callableShaderBindingTable = {};
 
-	uint32_t numOfProbes = lightProbes.size();
-	uint32_t isRaytrace = ShowOriginalRaytrace ? 1 : 0;
-	uint32_t isShowTexture = 0;
-	if (isRaytrace == 0)
+	const RayTracingConstants constants = { currentProbeIndex };
+	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+
+	// Execute ray tracing shaders, unless the primary visibility of the probe-shaded mode is rasterised.
+	if (renderMode == RenderMode::ProbeShaded && RasterisedPrimary)
+	{
+		GpuTimer().Begin(commandBuffer, "G-buffer raster");
+		Render_GBuffer(commandBuffer, imageIndex);
+		GpuTimer().End(commandBuffer);
+	}
+	else if (RayQuery)
+	{
+		const auto tileSize = RayTracingPipeline::ComputeTileSize;
+
+		GpuTimer().Begin(commandBuffer, "Trace (ray query)");
+		vkCmdDispatch(commandBuffer, (extent.width + tileSize - 1) / tileSize, (extent.height + tileSize - 1) / tileSize, 1);
+		GpuTimer().End(commandBuffer);
+	}
+	else
 	{
-		isShowTexture = ShowLightProbeTexture ? 1 : 0;
+		GpuTimer().Begin(commandBuffer, "Trace");
+		deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
+			&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
+			extent.width, extent.height, 1);
+		GpuTimer().End(commandBuffer);
 	}
 
-	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 0, sizeof(uint32_t), &numOfProbes);
-	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, sizeof(uint32_t), sizeof(uint32_t), &isShowTexture);
-	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 2* sizeof(uint32_t), sizeof(uint32_t), &isRaytrace);
-	vkCmdPushConstants(commandBuffer, rayTracingPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 3* sizeof(uint32_t), sizeof(uint32_t), &currentProbeIndex);
+	// Keep the accumulation and the primary hits of the frame, the next one reprojects them (see RenderModes.glsl).
+	if (renderMode == RenderMode::PathTraced && TemporalAccumulation)
+	{
+		const std::pair<const Image*, const Image*> historyCopies[] =
+		{
+			{accumulationImage_.get(), historyImage_.get()},
+			{gBufferDepthImage_.get(), historyDepthImage_.get()},
+			{gBufferNormalImage_.get(), historyNormalImage_.get()}
+		};
+
+		VkImageCopy historyRegion;
+		historyRegion.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		historyRegion.srcOffset = { 0, 0, 0 };
+		historyRegion.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		historyRegion.dstOffset = { 0, 0, 0 };
+		historyRegion.extent = { extent.width, extent.height, 1 };
+
+		GpuTimer().Begin(commandBuffer, "History copy");
+
+		for (const auto& [source, history] : historyCopies)
+		{
+			ImageMemoryBarrier::Insert(commandBuffer, source->Handle(), subresourceRange,
+				VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+
+			ImageMemoryBarrier::Insert(commandBuffer, history->Handle(), subresourceRange,
+				VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+
+			vkCmdCopyImage(commandBuffer,
+				source->Handle(), VK_IMAGE_LAYOUT_GENERAL,
+				history->Handle(), VK_IMAGE_LAYOUT_GENERAL,
+				1, &historyRegion);
+
+			ImageMemoryBarrier::Insert(commandBuffer, history->Handle(), subresourceRange,
+				VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+		}
+
+		GpuTimer().End(commandBuffer);
+	}
 
-	// Execute ray tracing shaders.
-	deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
-		&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
-		extent.width, extent.height, 1);
+	// The probe-shaded trace only wrote the G-buffer, the probes are gathered in a compute pass over it.
+	if (renderMode == RenderMode::ProbeShaded)
+	{
+		GpuTimer().Begin(commandBuffer, "Probe gather");
+		Render_ProbeGather(commandBuffer, imageIndex);
+		GpuTimer().End(commandBuffer);
+	}
 
 	// Acquire output image and swap-chain image for copying.
+	GpuTimer().Begin(commandBuffer, "Copy");
 	ImageMemoryBarrier::Insert(commandBuffer, outputImage_->Handle(), subresourceRange, 
 		VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
@@ -277,6 +684,7 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 
 	ImageMemoryBarrier::Insert(commandBuffer, SwapChain().Images()[imageIndex], subresourceRange, VK_ACCESS_TRANSFER_WRITE_BIT,
 		0, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	GpuTimer().End(commandBuffer);
 
 
 	 
@@ -308,12 +716,93 @@ void Application::Render(VkCommandBuffer commandBuffer, const uint32_t imageInde
 
 }
 
-void Application::Render_LightProbe(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+void Application::OnFrameRecorded(const uint32_t imageIndex)
 {
+	// Frames rasterizing the scene or path tracing it do not touch the probes (unless they transfer probe data), they may
+	// still carry a bake submission.
+	if (!isProbeFrame_ && !isProbeBakeRecorded_)
+	{
+		return;
+	}
 
+	hasProbeBakeTimes_ = isProbeBakeRecorded_;
 
-	const auto extent = SwapChain().Extent();
+	// The frame samples the probes as of the bake submissions before its own, which then overlaps the whole frame.
+	const uint64_t sampledBakeValue = probeBakeValue_;
+
+	if (isProbeBakeRecorded_)
+	{
+		const uint64_t waitValue = probeReadValue_;
+		const uint64_t signalValue = ++probeBakeValue_;
+
+		VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+		timelineInfo.waitSemaphoreValueCount = 1;
+		timelineInfo.pWaitSemaphoreValues = &waitValue;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+		VkCommandBuffer commandBuffers[] = { (*probeBakeCommandBuffers_)[imageIndex] };
+		VkSemaphore waitSemaphores[] = { probeReadSemaphore_->Handle() };
+		VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT };
+		VkSemaphore signalSemaphores[] = { probeBakeSemaphore_->Handle() };
+
+		VkSubmitInfo submitInfo = {};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = waitSemaphores;
+		submitInfo.pWaitDstStageMask = waitStages;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = commandBuffers;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = signalSemaphores;
+
+		Check(vkQueueSubmit(Device().ComputeQueue(), 1, &submitInfo, nullptr),
+			"submit light probe bake command buffer");
+
+		probeBakeImageValues_[imageIndex] = signalValue;
+		isProbeBakeRecorded_ = false;
+	}
+
+	// Only the probe filtering, the main trace and the gather wait for the previous bake, the rest of the frame overlaps it.
+	// The bake submitted with the frame only waits for the frames before it (probeReadValue_), and may update texels
+	// this frame samples: the shading then picks up a texel of the next estimate a frame early, as the bake and the
+	// hysteresis updates only ever move a texel from one converging estimate to the next.
+	// A frame holding back the bake has none, its transfers wait for every previous bake instead.
+	if (isProbeFrame_)
+	{
+		if (probeWaitStages_ != 0)
+		{
+			AddFrameWait(*probeBakeSemaphore_, sampledBakeValue, probeWaitStages_);
+		}
 
+		AddFrameSignal(*probeReadSemaphore_, ++probeReadValue_);
+	}
+
+	isProbeFrame_ = false;
+	isProbeBakeHeld_ = false;
+	probeWaitStages_ = 0;
+}
+
+void Application::RecordProbeBake(const uint32_t imageIndex, const char* const passName)
+{
+	// The command buffer of this image is free again once its previous bake has completed, which also makes the active
+	// texel count of that bake available to the host.
+	probeBakeSemaphore_->Wait(probeBakeImageValues_[imageIndex], std::numeric_limits<uint64_t>::max());
+
+	const auto commandBuffer = probeBakeCommandBuffers_->Begin(imageIndex);
+	probeBakeGpuTimer_->BeginFrame(commandBuffer, imageIndex);
+	probeBakeGpuTimer_->Begin(commandBuffer, passName);
+	Render_LightProbe(commandBuffer, imageIndex);
+	probeBakeGpuTimer_->End(commandBuffer);
+	probeBakeCommandBuffers_->End(imageIndex);
+
+	isProbeBakeRecorded_ = true;
+}
+
+void Application::Render_LightProbe(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
 	VkDescriptorSet descriptorSets[] = { lightProbeRTPipeline->DescriptorSet(imageIndex) };
 
 	VkImageSubresourceRange subresourceRange = {};
@@ -324,9 +813,11 @@ void Application::Render_LightProbe(VkCommandBuffer commandBuffer, uint32_t imag
 	subresourceRange.layerCount = 1;
 
 
-	// Bind ray tracing pipeline.
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, lightProbeRTPipeline->Handle());
-	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, lightProbeRTPipeline->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+	// Bind ray tracing pipeline, or the ray query compute pipeline.
+	const auto bindPoint = RayQuery ? VK_PIPELINE_BIND_POINT_COMPUTE : VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR;
+
+	vkCmdBindPipeline(commandBuffer, bindPoint, RayQuery ? lightProbeRTPipeline->ComputePipelineHandle() : lightProbeRTPipeline->Handle());
+	vkCmdBindDescriptorSets(commandBuffer, bindPoint, lightProbeRTPipeline->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
 
 	// Describe the shader binding table.
 	VkStridedDeviceAddressRegionKHR raygenShaderBindingTable = {};
@@ -346,30 +837,203 @@ void Application::Render_LightProbe(VkCommandBuffer commandBuffer, uint32_t imag
 
 	VkStridedDeviceAddressRegionKHR callableShaderBindingTable = {};
 
-	// Execute ray tracing shaders.
+	// Only spend this frame's ray budget, the remaining samples are accumulated over the next frames.
+	// Once baked, the probes are relit a few at a time and blended into the previous result instead.
+	const bool isUpdate = probeBakeScheduler->IsComplete();
+
+	// The bake budget goes to the texels that have not converged yet, as counted by the last frame rendered to this image.
+	auto& activeTexelBufferMemory = *lightProbeActiveTexelBufferMemories[imageIndex];
 
-	for (int i = 0; i < lightProbes.size(); i++)
+	if (!isUpdate && lightProbeBakedTexels[imageIndex] != 0)
 	{
+		const auto activeTexels = *static_cast<const uint32_t*>(activeTexelBufferMemory.Map(0, sizeof(uint32_t)));
+		activeTexelBufferMemory.Unmap();
 
+		probeBakeScheduler->SetActiveTexelRatio(static_cast<float>(static_cast<double>(activeTexels) / lightProbeBakedTexels[imageIndex]));
+	}
 
-		uint32_t index = i;
-		vkCmdPushConstants(commandBuffer, lightProbeRTPipeline->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 0, sizeof(uint32_t), &index);
+	const auto batches = isUpdate
+		? probeBakeScheduler->NextUpdateBatches(probeUpdateCount, probeUpdateSamples)
+		: probeBakeScheduler->NextBatches(probeBakeBudget);
+	const float hysteresis = isUpdate ? probeHysteresis : 0.0f;
 
-		deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
-			&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
-			1024, 1024, 1);
+	lightProbeBakedTexels[imageIndex] = 0;
+
+	if (!isUpdate)
+	{
+		for (const auto& batch : batches)
+		{
+			lightProbeBakedTexels[imageIndex] += static_cast<uint64_t>(batch.ProbeCount) * lightProbeConfig.RadianceTexels();
+		}
+
+		vkCmdFillBuffer(commandBuffer, lightProbeActiveTexelBuffers[imageIndex]->Handle(), 0, sizeof(uint32_t), 0);
+
+		VkMemoryBarrier fillBarrier = {};
+		fillBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		fillBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &fillBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	// Wait for the previous bake dispatches, the frames sampling the probes are waited for by the submission (see OnFrameRecorded).
+	ProbeMemoryBarrier(commandBuffer);
+
+	// Execute ray tracing shaders, one dispatch per batch with one launch slice per probe.
+	for (size_t i = 0; i != batches.size(); ++i)
+	{
+		const auto& batch = batches[i];
+
+		// A batch wrapping into the next pass may revisit probes written by the previous one.
+		if (i != 0)
+		{
+			ProbeMemoryBarrier(commandBuffer);
+		}
+
+		const LightProbeConstants constants = { batch.FirstProbe, batch.SampleOffset, batch.SampleCount, hysteresis };
+		vkCmdPushConstants(commandBuffer, lightProbeRTPipeline->PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+
+		if (RayQuery)
+		{
+			const auto tiles = (lightProbeConfig.RadianceResolution + LightProbeRTPipeline::ComputeTileSize - 1) / LightProbeRTPipeline::ComputeTileSize;
+			vkCmdDispatch(commandBuffer, tiles, tiles, batch.ProbeCount);
+		}
+		else
+		{
+			deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
+				&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
+				lightProbeConfig.RadianceResolution, lightProbeConfig.RadianceResolution, batch.ProbeCount);
+		}
+	}
+
+	// Make the active texel count visible to the host, which reads it once the bake has completed (see RecordProbeBake).
+	if (!isUpdate)
+	{
+		VkMemoryBarrier hostBarrier = {};
+		hostBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		hostBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &hostBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	isProbeFilteringOutdated = isProbeFilteringOutdated || !batches.empty();
+}
+
+void Application::Render_ProbeSH(VkCommandBuffer commandBuffer)
+{
+	VkDescriptorSet descriptorSets[] = { lightProbeSHPipeline->DescriptorSet() };
+
+	// The radiance is written by the bake, and the SH coefficients of the previous frame may still be read by the main pass
+	// and the probe gather.
+	ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lightProbeSHPipeline->Handle());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lightProbeSHPipeline->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+	vkCmdDispatch(commandBuffer, static_cast<uint32_t>(lightProbePos.size()), 1, 1);
+
+	ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+}
+
+void Application::Render_GBuffer(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+{
+	// A negative distance marks the pixels that no triangle covers, as a ray miss would.
+	std::array<VkClearValue, GBufferPipeline::AttachmentCount> clearValues = {};
+	clearValues[0].color = { {-1.0f, 0.0f, 0.0f, 0.0f} };
+	clearValues[1].color = { {0.0f, 0.0f, 1.0f, 0.0f} };
+	clearValues[2].color = { {0.0f, 0.0f, 0.0f, 0.0f} };
+	clearValues[3].depthStencil = { 1.0f, 0 };
+
+	VkRenderPassBeginInfo renderPassInfo = {};
+	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassInfo.renderPass = gBufferPipeline_->RenderPassHandle();
+	renderPassInfo.framebuffer = gBufferPipeline_->FramebufferHandle();
+	renderPassInfo.renderArea.offset = { 0, 0 };
+	renderPassInfo.renderArea.extent = SwapChain().Extent();
+	renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+	renderPassInfo.pClearValues = clearValues.data();
+
+	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	{
+		const auto& scene = GetScene();
+
+		VkDescriptorSet descriptorSets[] = { gBufferPipeline_->DescriptorSet(imageIndex) };
+		VkBuffer vertexBuffers[] = { scene.VertexBuffer().Handle() };
+		const VkBuffer indexBuffer = scene.IndexBuffer().Handle();
+		VkDeviceSize offsets[] = { 0 };
+
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline_->Handle());
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gBufferPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+		vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+		uint32_t vertexOffset = 0;
+		uint32_t indexOffset = 0;
+
+		for (const auto& model : scene.Models())
+		{
+			const auto vertexCount = static_cast<uint32_t>(model.NumberOfVertices());
+			const auto indexCount = static_cast<uint32_t>(model.NumberOfIndices());
+
+			vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+
+			vertexOffset += vertexCount;
+			indexOffset += indexCount;
+		}
+	}
+	vkCmdEndRenderPass(commandBuffer);
+}
+
+void Application::Render_ProbeGather(VkCommandBuffer commandBuffer, const uint32_t imageIndex)
+{
+	const auto extent = SwapChain().Extent();
+	VkDescriptorSet descriptorSets[] = { probeGatherPipeline_->DescriptorSet(imageIndex) };
+
+	VkImageSubresourceRange subresourceRange = {};
+	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	subresourceRange.baseMipLevel = 0;
+	subresourceRange.levelCount = 1;
+	subresourceRange.baseArrayLayer = 0;
+	subresourceRange.layerCount = 1;
 
-		//ImageMemoryBarrier::Insert(
-		//	commandBuffer,
-		//	lightProbes[i].radianceDistribution->probeImage->Handle(),
-		//	subresourceRange,
-		//	VK_ACCESS_SHADER_WRITE_BIT, // srcAccessMask: No accesses need to be completed before the barrier
-		//	VK_ACCESS_SHADER_READ_BIT, // dstAccessMask: Shader writes must wait for the barrier
-		//	VK_IMAGE_LAYOUT_GENERAL, // oldLayout: The initial layout is undefined
-		//	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL // newLayout: We want to transition to the general layout
-		//);
+	for (const auto& image : { gBufferDepthImage_.get(), gBufferNormalImage_.get(), gBufferAlbedoImage_.get() })
+	{
+		ImageMemoryBarrier::Insert(commandBuffer, image->Handle(), subresourceRange, VK_ACCESS_SHADER_WRITE_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+	}
+
+	const ProbeGatherConstants constants = { ProbeSHShading ? 1u : 0u };
+	const uint32_t tileSize = ProbeGatherPipeline::TileSize;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, probeGatherPipeline_->Handle());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, probeGatherPipeline_->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+	vkCmdPushConstants(commandBuffer, probeGatherPipeline_->PipelineLayout().Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+	vkCmdDispatch(commandBuffer, (extent.width + tileSize - 1) / tileSize, (extent.height + tileSize - 1) / tileSize, 1);
+}
+
+void Application::Render_ProbeGlossy(VkCommandBuffer commandBuffer)
+{
+	VkDescriptorSet descriptorSets[] = { lightProbeGlossyPipeline->DescriptorSet() };
+
+	// Same dependencies as the SH projection, which has just waited for the bake.
+	ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lightProbeGlossyPipeline->Handle());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, lightProbeGlossyPipeline->PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+
+	// Each level is blurred from the previous one.
+	for (uint32_t level = 0; level != lightProbeConfig.GlossyLevels; ++level)
+	{
+		if (level != 0)
+		{
+			ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+		}
+
+		vkCmdPushConstants(commandBuffer, lightProbeGlossyPipeline->PipelineLayout().Handle(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(level), &level);
+		vkCmdDispatch(commandBuffer, static_cast<uint32_t>(lightProbePos.size()), 1, 1);
 	}
 
+	ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
 }
 
 void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
@@ -400,10 +1064,10 @@ void Application::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
 		aabbOffset += sizeof(VkAabbPositionsKHR);
 	}
 
-	// Allocate the structures memory.
+	// Allocate the structures memory, shared with the compute queue the light probe bake traces them on.
 	const auto total = GetTotalRequirements(bottomAs_);
 
-	bottomBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
+	bottomBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, VK_SHARING_MODE_CONCURRENT));
 	bottomBufferMemory_.reset(new DeviceMemory(bottomBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	bottomScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
 	bottomScratchBufferMemory_.reset(new DeviceMemory(bottomScratchBuffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
@@ -462,10 +1126,10 @@ void Application::CreateTopLevelStructures(VkCommandBuffer commandBuffer)
 		static_cast<uint32_t>(instances.size())
 	);
 
-	// Allocate the structure memory.
+	// Allocate the structure memory, shared with the compute queue the light probe bake traces it on.
 	const auto total = GetTotalRequirements(topAs_);
 
-	topBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
+	topBuffer_.reset(new Buffer(Device(), total.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR, VK_SHARING_MODE_CONCURRENT));
 	topBufferMemory_.reset(new DeviceMemory(topBuffer_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 
 	topScratchBuffer_.reset(new Buffer(Device(), total.buildScratchSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
@@ -484,33 +1148,6 @@ void Application::CreateTopLevelStructures(VkCommandBuffer commandBuffer)
 
 
 	debugUtils.SetObjectName(topAs_[0].Handle(), "TLAS");
-
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = 1;
-	subresourceRange.baseArrayLayer = 0;
-	subresourceRange.layerCount = 1;
-
-	if (!isLightProbeCreated)
-	{
-		CreateProbeTextureImage();
-
-		for (int i = 0; i < lightProbes.size(); i++)
-		{
-			// Insert a memory barrier to transition the image layout to VK_IMAGE_LAYOUT_GENERAL
-			ImageMemoryBarrier::Insert(
-				commandBuffer,
-				lightProbes[i].radianceDistribution->probeImage->Handle(),
-				subresourceRange,
-				0, // srcAccessMask: No accesses need to be completed before the barrier
-				VK_ACCESS_SHADER_WRITE_BIT, // dstAccessMask: Shader writes must wait for the barrier
-				VK_IMAGE_LAYOUT_UNDEFINED, // oldLayout: The initial layout is undefined
-				VK_IMAGE_LAYOUT_GENERAL // newLayout: We want to transition to the general layout
-			);
-		}
-		isLightProbeCreated = true;
-	}
 }
 
 void Application::CreateOutputImage()
@@ -519,7 +1156,7 @@ void Application::CreateOutputImage()
 	const auto format = SwapChain().Format();
 	const auto tiling = VK_IMAGE_TILING_OPTIMAL;
 
-	accumulationImage_.reset(new Image(Device(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT));
+	accumulationImage_.reset(new Image(Device(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
 	accumulationImageMemory_.reset(new DeviceMemory(accumulationImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	accumulationImageView_.reset(new ImageView(Device(), accumulationImage_->Handle(), VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
 
@@ -527,6 +1164,36 @@ void Application::CreateOutputImage()
 	outputImageMemory_.reset(new DeviceMemory(outputImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
 	outputImageView_.reset(new ImageView(Device(), outputImage_->Handle(), format, VK_IMAGE_ASPECT_COLOR_BIT));
 
+	// G-buffer of the probe-shaded mode (see ProbeGather.comp), traced or rasterised.
+	gBufferDepthImage_.reset(new Image(Device(), extent, VK_FORMAT_R32_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+	gBufferDepthImageMemory_.reset(new DeviceMemory(gBufferDepthImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	gBufferDepthImageView_.reset(new ImageView(Device(), gBufferDepthImage_->Handle(), VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+
+	gBufferNormalImage_.reset(new Image(Device(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+	gBufferNormalImageMemory_.reset(new DeviceMemory(gBufferNormalImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	gBufferNormalImageView_.reset(new ImageView(Device(), gBufferNormalImage_->Handle(), VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+
+	gBufferAlbedoImage_.reset(new Image(Device(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT));
+	gBufferAlbedoImageMemory_.reset(new DeviceMemory(gBufferAlbedoImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	gBufferAlbedoImageView_.reset(new ImageView(Device(), gBufferAlbedoImage_->Handle(), VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+
+	// History of the temporal reprojection (see RenderModes.glsl), copied from the accumulation and G-buffer images after
+	// each path traced frame. They stay in the general layout so that their content survives across frames.
+	historyImage_.reset(new Image(Device(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+	historyImageMemory_.reset(new DeviceMemory(historyImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	historyImageView_.reset(new ImageView(Device(), historyImage_->Handle(), VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+	historyImage_->TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+
+	historyDepthImage_.reset(new Image(Device(), extent, VK_FORMAT_R32_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+	historyDepthImageMemory_.reset(new DeviceMemory(historyDepthImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	historyDepthImageView_.reset(new ImageView(Device(), historyDepthImage_->Handle(), VK_FORMAT_R32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+	historyDepthImage_->TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+
+	historyNormalImage_.reset(new Image(Device(), extent, VK_FORMAT_R16G16B16A16_SFLOAT, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT));
+	historyNormalImageMemory_.reset(new DeviceMemory(historyNormalImage_->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+	historyNormalImageView_.reset(new ImageView(Device(), historyNormalImage_->Handle(), VK_FORMAT_R16G16B16A16_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
+	historyNormalImage_->TransitionImageLayout(CommandPool(), VK_IMAGE_LAYOUT_GENERAL);
+
 	const auto& debugUtils = Device().DebugUtils();
 	
 	debugUtils.SetObjectName(accumulationImage_->Handle(), "Accumulation Image");
@@ -537,76 +1204,531 @@ void Application::CreateOutputImage()
 	debugUtils.SetObjectName(outputImageMemory_->Handle(), "Output Image Memory");
 	debugUtils.SetObjectName(outputImageView_->Handle(), "Output ImageView");
 
+	debugUtils.SetObjectName(gBufferDepthImage_->Handle(), "G-Buffer Depth Image");
+	debugUtils.SetObjectName(gBufferDepthImageMemory_->Handle(), "G-Buffer Depth Image Memory");
+	debugUtils.SetObjectName(gBufferDepthImageView_->Handle(), "G-Buffer Depth ImageView");
+
+	debugUtils.SetObjectName(gBufferNormalImage_->Handle(), "G-Buffer Normal Image");
+	debugUtils.SetObjectName(gBufferNormalImageMemory_->Handle(), "G-Buffer Normal Image Memory");
+	debugUtils.SetObjectName(gBufferNormalImageView_->Handle(), "G-Buffer Normal ImageView");
+
+	debugUtils.SetObjectName(gBufferAlbedoImage_->Handle(), "G-Buffer Albedo Image");
+	debugUtils.SetObjectName(gBufferAlbedoImageMemory_->Handle(), "G-Buffer Albedo Image Memory");
+	debugUtils.SetObjectName(gBufferAlbedoImageView_->Handle(), "G-Buffer Albedo ImageView");
+
+	debugUtils.SetObjectName(historyImage_->Handle(), "History Image");
+	debugUtils.SetObjectName(historyImageMemory_->Handle(), "History Image Memory");
+	debugUtils.SetObjectName(historyImageView_->Handle(), "History ImageView");
+
+	debugUtils.SetObjectName(historyDepthImage_->Handle(), "History Depth Image");
+	debugUtils.SetObjectName(historyDepthImageMemory_->Handle(), "History Depth Image Memory");
+	debugUtils.SetObjectName(historyDepthImageView_->Handle(), "History Depth ImageView");
+
+	debugUtils.SetObjectName(historyNormalImage_->Handle(), "History Normal Image");
+	debugUtils.SetObjectName(historyNormalImageMemory_->Handle(), "History Normal Image Memory");
+	debugUtils.SetObjectName(historyNormalImageView_->Handle(), "History Normal ImageView");
+
+}
+
+void Application::CreateLightProbeRTPipeline(const std::vector<Assets::UniformBuffer>& uniformBuffers)
+{
+	// One active texel counter per uniform buffer (i.e. per swapchain image): it is read back when the image is rendered again.
+	for (size_t i = 0; i != uniformBuffers.size(); ++i)
+	{
+		lightProbeActiveTexelBuffers.emplace_back(new Buffer(Device(), sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_CONCURRENT));
+		lightProbeActiveTexelBufferMemories.emplace_back(new DeviceMemory(lightProbeActiveTexelBuffers.back()->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+	}
+
+	lightProbeBakedTexels.assign(uniformBuffers.size(), 0);
+
+	lightProbeRTPipeline.reset(new LightProbeRTPipeline(*deviceProcedures_, topAs_[0], uniformBuffers, GetScene(), lightProbeConfig, *lightProbeAtlas, lightProbePosBuffer, lightProbeStatisticsBuffer, lightProbeActiveTexelBuffers, hasRayQuery_));
+
+	const std::vector<ShaderBindingTable::Entry> rayLPGenPrograms = { {lightProbeRTPipeline->RayGenShaderIndex(), {}} };
+	const std::vector<ShaderBindingTable::Entry> missLPPrograms = { {lightProbeRTPipeline->MissShaderIndex(), {}} };
+	const std::vector<ShaderBindingTable::Entry> hitLPGroups = { {lightProbeRTPipeline->TriangleHitGroupIndex(), {}}, {lightProbeRTPipeline->ProceduralHitGroupIndex(), {}} };
+
+	lightProbeShaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, *lightProbeRTPipeline, *rayTracingProperties_, rayLPGenPrograms, missLPPrograms, hitLPGroups));
+}
+
+void Application::DeleteLightProbeRTPipeline()
+{
+	lightProbeShaderBindingTable_.reset();
+	lightProbeRTPipeline.reset();
+	lightProbeActiveTexelBuffers.clear();
+	lightProbeActiveTexelBufferMemories.clear(); // release memory after bound buffer has been destroyed
+	lightProbeBakedTexels.clear();
 }
 
 void Application::CreateProbeTextureImage()
 {
+	// Either a single grid fitted to the scene, or probe cascades following the camera.
+	if (lightProbeConfig.Cascades == 0)
+	{
+		const LightProbePlacement placement(GetScene(), lightProbeConfig);
 
-	//TODO: automatic light probe placement
+		lightProbeCascades.reset(new LightProbeCascades(placement.Grid()));
+		lightProbeStates = placement.States();
+	}
+	else
+	{
+		const float spacing = lightProbeConfig.ProbeSpacing > 0.0f ? lightProbeConfig.ProbeSpacing : 1.0f;
 
-	int probeNum = 1000; // Total number of probes
-	const auto& debugUtils = Device().DebugUtils();
+		lightProbeCascades.reset(new LightProbeCascades(lightProbeConfig.Cascades, lightProbeConfig.CascadeResolution, spacing, CameraPosition()));
+		lightProbeStates.assign(lightProbeCascades->ProbeCount(), 1u);
+	}
+
+	numOfProbe = lightProbeCascades->ProbeCount();
+	lightProbeOffsets.assign(numOfProbe, glm::vec4(0.0f));
+
+	std::vector<uint32_t> allProbes(numOfProbe);
+	std::iota(allProbes.begin(), allProbes.end(), 0u);
+
+	const std::vector<LightProbeCascadesUniform> lightProbeCascadesUniform = { lightProbeCascades->Uniform() };
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeGrid", VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, lightProbeCascadesUniform, lightProbeGridBuffer, lightProbeGridBufferMemory);
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeState", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, lightProbeStates, lightProbeStateBuffer, lightProbeStateBufferMemory);
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeOffset", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, lightProbeOffsets, lightProbeOffsetBuffer, lightProbeOffsetBufferMemory);
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeRelocationList", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, allProbes, lightProbeRelocationListBuffer, lightProbeRelocationListBufferMemory);
+
+	lightProbeRelocationPipeline.reset(new LightProbeRelocationPipeline(*deviceProcedures_, topAs_[0], GetScene(), lightProbeGridBuffer, lightProbeStateBuffer, lightProbeOffsetBuffer, lightProbeRelocationListBuffer));
+
+	const std::vector<ShaderBindingTable::Entry> rayGenPrograms = { {lightProbeRelocationPipeline->RayGenShaderIndex(), {}} };
+	const std::vector<ShaderBindingTable::Entry> missPrograms = { {lightProbeRelocationPipeline->MissShaderIndex(), {}} };
+	const std::vector<ShaderBindingTable::Entry> hitGroups = { {lightProbeRelocationPipeline->TriangleHitGroupIndex(), {}}, {lightProbeRelocationPipeline->ProceduralHitGroupIndex(), {}} };
+
+	lightProbeRelocationShaderBindingTable_.reset(new ShaderBindingTable(*deviceProcedures_, lightProbeRelocationPipeline->Handle(), *rayTracingProperties_, rayGenPrograms, missPrograms, hitGroups));
+
+	// Move the probes out of the geometry, and deactivate the ones that cannot be used.
+	RelocateProbes(allProbes);
+
+	// Only the scrolling cascades relocate probes again later on.
+	if (!lightProbeCascades->IsScrolling())
+	{
+		lightProbeRelocationShaderBindingTable_.reset();
+		lightProbeRelocationPipeline.reset();
+	}
+
+	// Only a fixed number of probes may be resident in the atlas, the other ones being paged out to host memory.
+	const auto slotCount = lightProbeConfig.ResidentProbeCount != 0 ? std::min(lightProbeConfig.ResidentProbeCount, numOfProbe) : numOfProbe;
+	const auto activeProbeCount = static_cast<uint32_t>(std::count(lightProbeStates.begin(), lightProbeStates.end(), 1u));
+
+	lightProbeResidency.reset(new LightProbeResidency(numOfProbe, slotCount));
+	lightProbeResidency->Update(ProbePriorities());
+
+	// The active and resident probes change as the cascades scroll and the camera moves, so the compact bake list
+	// is allocated for all the atlas slots.
+	UpdateProbeList({});
+	std::vector<glm::vec4> lightProbePosCapacity(slotCount, glm::vec4(0.0f));
+	std::copy(lightProbePos.begin(), lightProbePos.end(), lightProbePosCapacity.begin());
+
+	lightProbeAtlas.reset(new LightProbeAtlas(Device(), lightProbeConfig, slotCount));
+	probeBakeScheduler.reset(new ProbeBakeScheduler(static_cast<uint32_t>(lightProbePos.size()), lightProbeConfig.RadianceTexels(), lightProbeConfig.SamplesPerTexel, lightProbeConfig.MaxSamplesPerTexel()));
+
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbePos", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, lightProbePosCapacity, lightProbePosBuffer, lightProbePosBufferMemory, VK_SHARING_MODE_CONCURRENT);
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeSlot", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, lightProbeResidency->Slots(), lightProbeSlotBuffer, lightProbeSlotBufferMemory);
+
+	// L2 spherical harmonics of the probe radiance, projected after every bake or update (see Render_ProbeSH).
+	const std::vector<float> lightProbeSH(static_cast<size_t>(slotCount) * LightProbeConfig::SHFloats, 0.0f);
+	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbeSH", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, lightProbeSH, lightProbeSHBuffer, lightProbeSHBufferMemory);
+
+	// Adaptive bake statistics of every radiance texel of the atlas, reset by the first pass of each bake.
+	const auto statisticsSize = static_cast<VkDeviceSize>(slotCount) * lightProbeConfig.RadianceTexels() * sizeof(glm::vec4);
+	lightProbeStatisticsBuffer.reset(new Buffer(Device(), statisticsSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_CONCURRENT));
+	lightProbeStatisticsBufferMemory.reset(new DeviceMemory(lightProbeStatisticsBuffer->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+
+	// The probe maps stay in the general layout, they are both written by the bake and sampled by the main pass.
+	SingleTimeCommands::Submit(CommandPool(), [this](VkCommandBuffer commandBuffer)
+	{
+		lightProbeAtlas->TransitionToGeneral(commandBuffer);
+	});
+
+	// Skip the bake altogether if it has already been done for this scene and configuration.
+	// The cascades and the resident probes depend on the camera path, they are never cached.
+	if (!lightProbeConfig.CacheDirectory.empty() && !lightProbeCascades->IsScrolling() && lightProbeResidency->IsComplete())
+	{
+		lightProbeCache.reset(new LightProbeCache(GetScene(), GetUniformBufferObject({ 1, 1 }).HasSky != 0, lightProbeConfig));
+
+		if (lightProbeCache->Load(CommandPool(), lightProbeCascades->Grids()[0], lightProbes, lightProbeStates, *lightProbeAtlas))
+		{
+			probeBakeScheduler->Complete();
+			std::cout << "- loaded light probes from '" << lightProbeCache->Path() << "'" << std::endl;
+		}
+	}
+
+	const auto& grid = lightProbeCascades->Grids()[0];
+	const auto radianceSide = lightProbeConfig.RadianceResolution + 2 * LightProbeAtlas::Gutter;
+	const auto depthSide = lightProbeConfig.DepthResolution + 2 * LightProbeAtlas::Gutter;
+	const auto probeSize = radianceSide * radianceSide * lightProbeConfig.RadianceTexelSize() + 2 * depthSide * depthSide * 4;
+	std::cout << "- placed " << activeProbeCount << " of " << numOfProbe << " light probes (" << lightProbeCascades->Grids().size() << " x " << grid.Count.x << "x" << grid.Count.y << "x" << grid.Count.z
+		<< " grid, spacing " << grid.Spacing.x << ", " << lightProbeConfig.RadianceResolution << "x" << lightProbeConfig.RadianceResolution
+		<< ", " << slotCount << " resident, " << (slotCount * probeSize) / (1024.0 * 1024.0) << " MB)" << std::endl;
+}
+
+void Application::RelocateProbes(const std::vector<uint32_t>& probeIndices)
+{
+	const auto probeCount = static_cast<uint32_t>(probeIndices.size());
+
+	Vulkan::BufferUtil::CopyFromStagingBuffer(CommandPool(), *lightProbeRelocationListBuffer, probeIndices);
+
+	SingleTimeCommands::Submit(CommandPool(), [&](VkCommandBuffer commandBuffer)
+	{
+		RecordProbeRelocation(commandBuffer, probeCount);
+	});
+
+	const auto states = Vulkan::BufferUtil::CopyToHost<uint32_t>(CommandPool(), *lightProbeStateBuffer, numOfProbe);
+
+	// Keep the voxel classification of the placement if the rays see no usable probe at all (e.g. a scene without any closed surface).
+	// This only applies to the initial relocation, probes scrolling into a cascade may all legitimately be out of use.
+	if (probeCount == numOfProbe && std::find(states.begin(), states.end(), 1u) == states.end())
+	{
+		std::cerr << "WARNING: light probe relocation deactivated every probe, keeping the probe placement" << std::endl;
+		Vulkan::BufferUtil::CopyFromStagingBuffer(CommandPool(), *lightProbeStateBuffer, lightProbeStates);
+		Vulkan::BufferUtil::CopyFromStagingBuffer(CommandPool(), *lightProbeOffsetBuffer, lightProbeOffsets);
+		return;
+	}
+
+	lightProbeStates = states;
+	lightProbeOffsets = Vulkan::BufferUtil::CopyToHost<glm::vec4>(CommandPool(), *lightProbeOffsetBuffer, numOfProbe);
+}
+
+void Application::RecordProbeRelocation(VkCommandBuffer commandBuffer, const uint32_t probeCount)
+{
+	const auto& pipeline = *lightProbeRelocationPipeline;
+	const auto& shaderBindingTable = *lightProbeRelocationShaderBindingTable_;
+
+	VkDescriptorSet descriptorSets[] = { pipeline.DescriptorSet() };
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline.Handle());
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR, pipeline.PipelineLayout().Handle(), 0, 1, descriptorSets, 0, nullptr);
+
+	// Describe the shader binding table.
+	VkStridedDeviceAddressRegionKHR raygenShaderBindingTable = {};
+	raygenShaderBindingTable.deviceAddress = shaderBindingTable.RayGenDeviceAddress();
+	raygenShaderBindingTable.stride = shaderBindingTable.RayGenEntrySize();
+	raygenShaderBindingTable.size = shaderBindingTable.RayGenSize();
+
+	VkStridedDeviceAddressRegionKHR missShaderBindingTable = {};
+	missShaderBindingTable.deviceAddress = shaderBindingTable.MissDeviceAddress();
+	missShaderBindingTable.stride = shaderBindingTable.MissEntrySize();
+	missShaderBindingTable.size = shaderBindingTable.MissSize();
 
-	lightProbes.reserve(probeNum);
-	lightProbePos.reserve(probeNum);
+	VkStridedDeviceAddressRegionKHR hitShaderBindingTable = {};
+	hitShaderBindingTable.deviceAddress = shaderBindingTable.HitGroupDeviceAddress();
+	hitShaderBindingTable.stride = shaderBindingTable.HitGroupEntrySize();
+	hitShaderBindingTable.size = shaderBindingTable.HitGroupSize();
+
+	VkStridedDeviceAddressRegionKHR callableShaderBindingTable = {};
+
+	// Each iteration traces from the probe positions moved by the previous one, the last dispatch classifies the probes.
+	for (uint32_t i = 0; i <= lightProbeConfig.RelocationIterations; ++i)
+	{
+		if (i != 0)
+		{
+			ProbeMemoryBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR);
+		}
+
+		const LightProbeRelocationConstants constants = { i, i != lightProbeConfig.RelocationIterations, lightProbeConfig.RelocationRayCount, lightProbeConfig.RelocationMaxOffset };
+		vkCmdPushConstants(commandBuffer, pipeline.PipelineLayout().Handle(), VK_SHADER_STAGE_RAYGEN_BIT_KHR, 0, sizeof(constants), &constants);
+
+		deviceProcedures_->vkCmdTraceRaysKHR(commandBuffer,
+			&raygenShaderBindingTable, &missShaderBindingTable, &hitShaderBindingTable, &callableShaderBindingTable,
+			probeCount, 1, 1);
+	}
+}
+
+ProbeTransfer& Application::BeginProbeTransfer()
+{
+	// A single transfer per frame, complete once the frame being recorded signals the next probe read value (see OnFrameRecorded).
+	if (!probeTransfer_)
+	{
+		probeTransfer_.reset(new ProbeTransfer(Device()));
+		probeTransferValue_ = probeReadValue_ + 1;
+		isProbeFrame_ = true;
+	}
+
+	return *probeTransfer_;
+}
+
+void Application::ScrollProbes(VkCommandBuffer commandBuffer)
+{
+	const auto movedProbes = lightProbeCascades->Scroll(CameraPosition());
+
+	if (movedProbes.empty())
+	{
+		return;
+	}
+
+	// The probes entering a cascade start again from their grid position.
+	for (const auto probeIndex : movedProbes)
+	{
+		lightProbeStates[probeIndex] = 1;
+		lightProbeOffsets[probeIndex] = glm::vec4(0.0f);
+		lightProbeResidency->DiscardPage(probeIndex);
+	}
+
+	// The grid, state, offset and relocation buffers are only used by the frames, which execute in order: the moved probes
+	// are relocated by this frame without waiting for the bake, which goes on with the previous probe list meanwhile.
+	auto& transfer = BeginProbeTransfer();
+	const std::vector<LightProbeCascadesUniform> lightProbeCascadesUniform = { lightProbeCascades->Uniform() };
+	const auto relocationStages = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	const auto relocationAccess = VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-	// Define the side length and the number of probes per edge
-	float sideLength = 4.5f;
-	int probesPerEdge = 4;
+	GpuTimer().Begin(commandBuffer, "Probe scroll");
 
-	// Define the midpoints of the planes
-	std::vector<glm::vec3> midpoints = {
-		glm::vec3(0, 2.5, 0),
-		glm::vec3(0, 0, 0),
-		glm::vec3(0, -2.5, 0)
+	ProbeTransferBarrier(commandBuffer, relocationStages, relocationAccess, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	transfer.Upload(commandBuffer, *lightProbeGridBuffer, lightProbeCascadesUniform);
+	transfer.Upload(commandBuffer, *lightProbeStateBuffer, lightProbeStates);
+	transfer.Upload(commandBuffer, *lightProbeOffsetBuffer, lightProbeOffsets);
+	transfer.Upload(commandBuffer, *lightProbeRelocationListBuffer, movedProbes);
+
+	ProbeTransferBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, relocationStages, relocationAccess);
+
+	RecordProbeRelocation(commandBuffer, static_cast<uint32_t>(movedProbes.size()));
+
+	// The relocated states and offsets are read back for the bake list, and sampled by the rest of the frame.
+	ProbeTransferBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_SHADER_WRITE_BIT,
+		relocationStages | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT);
+
+	const auto stateReadBack = transfer.Download(commandBuffer, *lightProbeStateBuffer, sizeof(uint32_t) * numOfProbe);
+	const auto offsetReadBack = transfer.Download(commandBuffer, *lightProbeOffsetBuffer, sizeof(glm::vec4) * numOfProbe);
+
+	ProbeTransferBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+
+	GpuTimer().End(commandBuffer);
+
+	// Once this frame has completed, the moved probes that are still in use are baked again. The other probes keep their
+	// radiance, or the samples they have if the bake is still in progress.
+	applyProbeTransfer_ = [this, movedProbes, stateReadBack, offsetReadBack](VkCommandBuffer laterCommandBuffer, const ProbeTransfer& completedTransfer)
+	{
+		lightProbeStates = completedTransfer.Read<uint32_t>(stateReadBack, numOfProbe);
+		lightProbeOffsets = completedTransfer.Read<glm::vec4>(offsetReadBack, numOfProbe);
+
+		RestartProbeBake(laterCommandBuffer, movedProbes);
 	};
+}
+
+void Application::RestartProbeBake(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& dirtyProbes)
+{
+	const auto [dirtyProbeCount, bakeProbeCount] = UpdateProbeList(dirtyProbes);
+
+	// The bake reads the probe list (and the atlas pages): this frame holds back its own bake, and its transfers wait for
+	// the previous ones.
+	auto& transfer = BeginProbeTransfer();
+	isProbeBakeHeld_ = true;
+	probeWaitStages_ |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+	if (!lightProbePos.empty())
+	{
+		const auto filteringStages = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+
+		ProbeTransferBarrier(commandBuffer, filteringStages, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+		transfer.Upload(commandBuffer, *lightProbePosBuffer, lightProbePos);
+		ProbeTransferBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, filteringStages, VK_ACCESS_SHADER_READ_BIT);
+	}
+
+	probeBakeScheduler->Restart(static_cast<uint32_t>(lightProbePos.size()), dirtyProbeCount, bakeProbeCount);
+	isProbeFilteringOutdated = true;
+}
+
+std::pair<uint32_t, uint32_t> Application::UpdateProbeList(const std::vector<uint32_t>& dirtyProbes)
+{
+	// Bake order of each probe: the dirty probes, then the probes whose bake is in progress, then the baked ones.
+	enum BakeOrder : uint8_t { Dirty, Baking, Baked };
+	std::vector<uint8_t> bakeOrders(numOfProbe, Baked);
+
+	if (probeBakeScheduler && !probeBakeScheduler->IsComplete())
+	{
+		for (uint32_t i = 0; i != probeBakeScheduler->BakeProbeCount(); ++i)
+		{
+			bakeOrders[lightProbePosIndices[i]] = Baking;
+		}
+	}
+
+	for (const auto probeIndex : dirtyProbes)
+	{
+		bakeOrders[probeIndex] = Dirty;
+	}
+
+	lightProbes.clear();
+	lightProbes.reserve(numOfProbe);
+
+	for (uint32_t i = 0; i != numOfProbe; ++i)
+	{
+		lightProbes.emplace_back(lightProbeCascades->ProbePosition(i) + glm::vec3(lightProbeOffsets[i]));
+	}
 
-	// Loop through each plane
-	for (const auto& midpoint : midpoints) {
-		// Place probes at the vertices and edge midpoints of the square
-		for (int i = 0; i <= probesPerEdge; ++i) {
-			for (int j = 0; j <= probesPerEdge; ++j) {
-				float x = midpoint.x + (i - probesPerEdge/2) * sideLength / 2;
-				float y = midpoint.y;
-				float z = midpoint.z + (j - probesPerEdge/2) * sideLength / 2;
-
-				// Skip the center point of the middle plane
-				if ((x == 0.0f) && (y == 0.0f) && (z == 0.0f)) {
-					continue;
-				}
-
-				// Skip the center point, as we only want vertices and edge midpoints
-				lightProbes.emplace_back(glm::vec3(x, y, z), Device());
+	// Only the active and resident probes are baked: the bake reads its probe position and atlas slot (in w) from this compact list,
+	// which starts with the probes to bake so that they can be baked on their own.
+	lightProbePos.clear();
+	lightProbePosIndices.clear();
+
+	std::array<uint32_t, 3> counts = {};
+
+	for (const auto order : { Dirty, Baking, Baked })
+	{
+		for (uint32_t i = 0; i != numOfProbe; ++i)
+		{
+			if (lightProbeStates[i] != 0 && lightProbeResidency->IsResident(i) && bakeOrders[i] == order)
+			{
+				lightProbePos.emplace_back(lightProbes[i].position, static_cast<float>(lightProbeResidency->Slot(i)));
+				lightProbePosIndices.push_back(i);
+				++counts[order];
 			}
 		}
 	}
-	
-	//lightProbes.emplace_back(glm::vec3(0, 0, -3.5), Device());
-	//lightProbes.emplace_back(glm::vec3(0, 0, -2.5), Device());
 
-	numOfProbe = lightProbes.size();
+	return { counts[Dirty], counts[Dirty] + counts[Baking] };
+}
+
+void Application::UpdateResidency(VkCommandBuffer commandBuffer)
+{
+	const auto changes = lightProbeResidency->Update(ProbePriorities());
+
+	if (changes.empty())
+	{
+		return;
+	}
+
+	std::vector<uint32_t> pagedOutProbes;
+	std::vector<uint32_t> pagedOutSlots;
+	std::vector<uint32_t> pagedInSlots;
+	std::vector<uint8_t> pagedInPages;
+	std::vector<uint32_t> unbakedProbes;
+
+	const auto pageSize = lightProbeAtlas->PageSize();
+
+	for (const auto& change : changes)
+	{
+		if (!change.IsPagedIn)
+		{
+			// Only the active probes have baked data worth keeping.
+			if (lightProbeStates[change.Probe] != 0)
+			{
+				pagedOutProbes.push_back(change.Probe);
+				pagedOutSlots.push_back(change.Slot);
+			}
+		}
+		else if (lightProbeResidency->HasPage(change.Probe))
+		{
+			const auto page = lightProbeResidency->TakePage(change.Probe);
+
+			if (page.size() != pageSize)
+			{
+				Throw(std::invalid_argument("light probe page size does not match the probe atlas"));
+			}
+
+			pagedInSlots.push_back(change.Slot);
+			pagedInPages.insert(pagedInPages.end(), page.begin(), page.end());
+		}
+		else
+		{
+			unbakedProbes.push_back(change.Probe);
+		}
+	}
+
+	// The page copies are recorded into this frame, which holds back its bake and waits for the previous ones (see RestartProbeBake).
+	// The probes are paged out first, as the probes paged in may reuse their slots.
+	auto& transfer = BeginProbeTransfer();
+	const auto shadingStages = VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
 
-	for (int i = 0; i < lightProbes.size(); i++) {
+	GpuTimer().Begin(commandBuffer, "Probe paging");
 
-		lightProbePos.emplace_back(glm::vec4(lightProbes[i].position, 0.0f));
+	if (!pagedOutSlots.empty())
+	{
+		const auto pageReadBack = transfer.AddReadBackBuffer(pageSize * pagedOutSlots.size());
+		lightProbeAtlas->CopyLayersToBuffer(commandBuffer, pagedOutSlots, transfer.ReadBackBuffer(pageReadBack));
+
+		// The pages are kept once this frame has completed, the residency only changes again after that.
+		applyProbeTransfer_ = [this, pagedOutProbes, pageReadBack, pageSize](VkCommandBuffer, const ProbeTransfer& completedTransfer)
+		{
+			const auto pages = completedTransfer.Read<uint8_t>(pageReadBack, pageSize * pagedOutProbes.size());
 
-		debugUtils.SetObjectName(lightProbes[i].radianceDistribution->probeImage->Handle(), i + " : radianceDistribution Image");
-		debugUtils.SetObjectName(lightProbes[i].radianceDistribution->probeImageMemory->Handle(), i + " : radianceDistribution probeImageMemory");
-		debugUtils.SetObjectName(lightProbes[i].radianceDistribution->probeImageView->Handle(), i + " : radianceDistribution probeImageView");
+			for (size_t i = 0; i != pagedOutProbes.size(); ++i)
+			{
+				lightProbeResidency->StorePage(pagedOutProbes[i], std::vector<uint8_t>(pages.begin() + i * pageSize, pages.begin() + (i + 1) * pageSize));
+			}
+		};
 	}
 
+	if (!pagedInSlots.empty())
+	{
+		lightProbeAtlas->CopyLayersFromBuffer(commandBuffer, pagedInSlots, transfer.AddUploadBuffer(pagedInPages.data(), pagedInPages.size()));
+	}
 
-	Vulkan::BufferUtil::CreateDeviceBuffer(CommandPool(), "lightProbePos", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, lightProbePos, lightProbePosBuffer, lightProbePosBufferMemory);
-	
+	ProbeTransferBarrier(commandBuffer, shadingStages, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+	transfer.Upload(commandBuffer, *lightProbeSlotBuffer, lightProbeResidency->Slots());
+	ProbeTransferBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT, shadingStages, VK_ACCESS_SHADER_READ_BIT);
+
+	GpuTimer().End(commandBuffer);
+
+	// Only the probes paged in for the first time (first in the bake list) have to be baked.
+	RestartProbeBake(commandBuffer, unbakedProbes);
+}
+
+std::vector<float> Application::ProbePriorities() const
+{
+	const auto cameraToWorld = GetUniformBufferObject({ 1, 1 }).ModelViewInverse;
+	const glm::vec3 cameraPosition(cameraToWorld[3]);
+	const glm::vec3 cameraForward(-cameraToWorld[2]);
+
+	std::vector<float> priorities(numOfProbe);
+
+	// The closest probes first, the ones behind the camera counting as twice as far. Inactive probes are never resident.
+	for (uint32_t i = 0; i != numOfProbe; ++i)
+	{
+		const auto toProbe = lightProbeCascades->ProbePosition(i) + glm::vec3(lightProbeOffsets[i]) - cameraPosition;
+		const auto distance = glm::length(toProbe);
+
+		priorities[i] = lightProbeStates[i] == 0
+			? std::numeric_limits<float>::infinity()
+			: glm::dot(toProbe, cameraForward) < 0.0f ? 2.0f * distance : distance;
+	}
+
+	return priorities;
+}
+
+glm::vec3 Application::CameraPosition() const
+{
+	return glm::vec3(GetUniformBufferObject({ 1, 1 }).ModelViewInverse[3]);
 }
 
 void Application::DeleteProbeTextureImage()
 
 {
+	probeTransfer_.reset();
+	applyProbeTransfer_ = nullptr;
+	isProbeBakeHeld_ = false;
+	probeWaitStages_ = 0;
 	lightProbePos.clear();
+	lightProbePosIndices.clear();
 	lightProbePosBuffer.reset();
 	lightProbePosBufferMemory.reset();
+	lightProbeGridBuffer.reset();
+	lightProbeGridBufferMemory.reset();
+	lightProbeStateBuffer.reset();
+	lightProbeStateBufferMemory.reset();
+	lightProbeOffsetBuffer.reset();
+	lightProbeOffsetBufferMemory.reset();
+	lightProbeRelocationShaderBindingTable_.reset();
+	lightProbeRelocationPipeline.reset();
+	lightProbeRelocationListBuffer.reset();
+	lightProbeRelocationListBufferMemory.reset();
+	lightProbeSlotBuffer.reset();
+	lightProbeSlotBufferMemory.reset();
+	lightProbeSHBuffer.reset();
+	lightProbeSHBufferMemory.reset();
+	lightProbeStatisticsBuffer.reset();
+	lightProbeStatisticsBufferMemory.reset();
 	lightProbes.clear();
+	lightProbeStates.clear();
+	lightProbeOffsets.clear();
+	lightProbeAtlas.reset();
+	lightProbeCache.reset();
+	probeBakeScheduler.reset();
+	lightProbeCascades.reset();
+	lightProbeResidency.reset();
+	isProbeCacheOutdated = false;
+	isProbeFilteringOutdated = false;
 }
 
 }
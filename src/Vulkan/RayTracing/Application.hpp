@@ -1,16 +1,23 @@
 #pragma once
 
 #include "Vulkan/Application.hpp"
+#include "Vulkan/GpuTimer.hpp"
 #include "RayTracingProperties.hpp"
+#include "LightProbeConfig.hpp"
+#include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
+#include <functional>
+#include <utility>
 
 namespace Vulkan
 {
 	class CommandBuffers;
+	class CommandPool;
 	class Buffer;
 	class DeviceMemory;
 	class Image;
 	class ImageView;
+	class TimelineSemaphore;
 }
 
 namespace Vulkan::RayTracing
@@ -21,6 +28,10 @@ namespace Vulkan::RayTracing
 
 		VULKAN_NON_COPIABLE(Application);
 
+		// Bakes all the light probes without presenting anything (e.g. in a headless application), one fenced
+		// compute submission at a time, and writes them to the probe cache.
+		void BakeProbes();
+
 	protected:
 
 		Application(const WindowConfig& windowConfig, VkPresentModeKHR presentMode, bool enableValidationLayers);
@@ -37,24 +48,63 @@ namespace Vulkan::RayTracing
 		void CreateSwapChain() override;
 		void DeleteSwapChain() override;
 		void Render(VkCommandBuffer commandBuffer, uint32_t imageIndex) override;
+		void OnFrameRecorded(uint32_t imageIndex) override;
 		void Render_LightProbe(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		void Render_ProbeSH(VkCommandBuffer commandBuffer);
+		void Render_ProbeGlossy(VkCommandBuffer commandBuffer);
+		void Render_GBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+		void Render_ProbeGather(VkCommandBuffer commandBuffer, uint32_t imageIndex);
 		
 		auto getLightProbeIndex() { return numOfProbe; };
 		void setIsProbeTexture(bool temp) { ShowLightProbeTexture = temp; };
 		void setIsRaytrace(bool temp) { ShowOriginalRaytrace = temp; };
 		void setCurrentIndex(uint32_t index) { currentProbeIndex = index; };
+		void setProbeSHShading(bool temp) { ProbeSHShading = temp; };
+		void setRasterisedPrimary(bool temp) { RasterisedPrimary = temp; };
+		void setRayQuery(bool temp) { RayQuery = temp; };
+		bool HasRayQuery() const { return hasRayQuery_; }
+		void setTemporalAccumulation(bool temp) { TemporalAccumulation = temp; };
+		void setProbeBakeBudget(uint64_t raysPerFrame) { probeBakeBudget = raysPerFrame; };
+		void setProbeUpdate(uint32_t probesPerFrame, uint32_t samplesPerTexel, float hysteresis) { probeUpdateCount = probesPerFrame; probeUpdateSamples = samplesPerTexel; probeHysteresis = hysteresis; };
+		void setLightProbeConfig(const LightProbeConfig& config) { lightProbeConfig = config; };
+
+		float getProbeBakeProgress() const;
+		bool isProbeBakeComplete() const;
+
+		// GPU times of the passes of the last frames, the light probe bake on the compute queue included.
+		std::vector<GpuPassTime> GpuPassTimes() const;
+
 	private:
 
 		void CreateBottomLevelStructures(VkCommandBuffer commandBuffer);
 		void CreateTopLevelStructures(VkCommandBuffer commandBuffer);
 		void CreateOutputImage();
+		void CreateLightProbeRTPipeline(const std::vector<Assets::UniformBuffer>& uniformBuffers);
+		void DeleteLightProbeRTPipeline();
+		void RecordProbeBake(uint32_t imageIndex, const char* passName);
 		void CreateProbeTextureImage();
+		void RelocateProbes(const std::vector<uint32_t>& probeIndices);
+		void RecordProbeRelocation(VkCommandBuffer commandBuffer, uint32_t probeCount);
+		class ProbeTransfer& BeginProbeTransfer();
+		void ScrollProbes(VkCommandBuffer commandBuffer);
+		void RestartProbeBake(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& dirtyProbes);
+		std::pair<uint32_t, uint32_t> UpdateProbeList(const std::vector<uint32_t>& dirtyProbes);
+		void UpdateResidency(VkCommandBuffer commandBuffer);
+		std::vector<float> ProbePriorities() const;
+		glm::vec3 CameraPosition() const;
 		void DeleteProbeTextureImage();
 
 		std::unique_ptr<class DeviceProcedures> deviceProcedures_;
 		std::unique_ptr<class RayTracingProperties> rayTracingProperties_;
 		
+		LightProbeConfig lightProbeConfig;
+		std::unique_ptr<class LightProbeCascades> lightProbeCascades;
+		std::unique_ptr<class LightProbeResidency> lightProbeResidency;
 		std::vector<class LightProbe> lightProbes;
+		std::unique_ptr<class LightProbeAtlas> lightProbeAtlas;
+		std::unique_ptr<class ProbeBakeScheduler> probeBakeScheduler;
+		std::unique_ptr<class LightProbeCache> lightProbeCache;
+		std::vector<uint32_t> lightProbeStates;
 
 		std::vector<class BottomLevelAccelerationStructure> bottomAs_;
 		std::unique_ptr<Buffer> bottomBuffer_;
@@ -78,22 +128,119 @@ namespace Vulkan::RayTracing
 		std::unique_ptr<Image> outputImage_;
 		std::unique_ptr<DeviceMemory> outputImageMemory_;
 		std::unique_ptr<ImageView> outputImageView_;
+
+		std::unique_ptr<Image> gBufferDepthImage_;
+		std::unique_ptr<DeviceMemory> gBufferDepthImageMemory_;
+		std::unique_ptr<ImageView> gBufferDepthImageView_;
+
+		std::unique_ptr<Image> gBufferNormalImage_;
+		std::unique_ptr<DeviceMemory> gBufferNormalImageMemory_;
+		std::unique_ptr<ImageView> gBufferNormalImageView_;
+
+		std::unique_ptr<Image> gBufferAlbedoImage_;
+		std::unique_ptr<DeviceMemory> gBufferAlbedoImageMemory_;
+		std::unique_ptr<ImageView> gBufferAlbedoImageView_;
+
+		// Previous frame accumulation, primary hit distance and normal, reprojected by the path tracer.
+		std::unique_ptr<Image> historyImage_;
+		std::unique_ptr<DeviceMemory> historyImageMemory_;
+		std::unique_ptr<ImageView> historyImageView_;
+
+		std::unique_ptr<Image> historyDepthImage_;
+		std::unique_ptr<DeviceMemory> historyDepthImageMemory_;
+		std::unique_ptr<ImageView> historyDepthImageView_;
+
+		std::unique_ptr<Image> historyNormalImage_;
+		std::unique_ptr<DeviceMemory> historyNormalImageMemory_;
+		std::unique_ptr<ImageView> historyNormalImageView_;
 		
 		std::unique_ptr<class RayTracingPipeline> rayTracingPipeline_;
+		std::unique_ptr<class GBufferPipeline> gBufferPipeline_;
+		std::unique_ptr<class ProbeGatherPipeline> probeGatherPipeline_;
 		std::unique_ptr<class ShaderBindingTable> shaderBindingTable_;
 
 		std::unique_ptr<class LightProbeRTPipeline> lightProbeRTPipeline;
+		std::unique_ptr<class LightProbeSHPipeline> lightProbeSHPipeline;
+		std::unique_ptr<class LightProbeGlossyPipeline> lightProbeGlossyPipeline;
 		std::unique_ptr<class ShaderBindingTable> lightProbeShaderBindingTable_;
 
+		std::unique_ptr<class LightProbeRelocationPipeline> lightProbeRelocationPipeline;
+		std::unique_ptr<class ShaderBindingTable> lightProbeRelocationShaderBindingTable_;
+
+		// The compact bake list, and the probe of each of its entries.
 		std::vector<glm::vec4> lightProbePos;
+		std::vector<uint32_t> lightProbePosIndices;
 		std::unique_ptr<Buffer> lightProbePosBuffer;
 		std::unique_ptr<DeviceMemory> lightProbePosBufferMemory;
 
-		bool isPrecomputed = false;
-		bool isLightProbeCreated = false;
+		std::unique_ptr<Buffer> lightProbeGridBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeGridBufferMemory;
+
+		std::unique_ptr<Buffer> lightProbeStateBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeStateBufferMemory;
+
+		std::vector<glm::vec4> lightProbeOffsets;
+		std::unique_ptr<Buffer> lightProbeOffsetBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeOffsetBufferMemory;
+
+		std::unique_ptr<Buffer> lightProbeRelocationListBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeRelocationListBufferMemory;
+
+		std::unique_ptr<Buffer> lightProbeSlotBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeSlotBufferMemory;
+
+		std::unique_ptr<Buffer> lightProbeSHBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeSHBufferMemory;
+
+		// Adaptive bake: per texel statistics, and per swapchain image, the texels still sampled after the frame's bake
+		// dispatches (read back once the image comes around again) and the number of texels these dispatches covered.
+		std::unique_ptr<Buffer> lightProbeStatisticsBuffer;
+		std::unique_ptr<DeviceMemory> lightProbeStatisticsBufferMemory;
+		std::vector<std::unique_ptr<Buffer>> lightProbeActiveTexelBuffers;
+		std::vector<std::unique_ptr<DeviceMemory>> lightProbeActiveTexelBufferMemories;
+		std::vector<uint64_t> lightProbeBakedTexels;
+
+		// The bake and update dispatches run on the compute queue, overlapping the graphics work. The frames sampling
+		// the probes wait for the bake submissions before their own one (probeBakeSemaphore_), and each bake submission
+		// waits for the frames submitted before it to be done sampling the probes (probeReadSemaphore_): a frame and the
+		// bake submitted with it run side by side. The path traced frames only take part when they transfer probe data,
+		// and the frames rewriting the bake inputs (the probe list) record no bake and wait for all the previous ones
+		// (isProbeBakeHeld_).
+		std::unique_ptr<class CommandPool> probeBakeCommandPool_;
+		std::unique_ptr<CommandBuffers> probeBakeCommandBuffers_;
+		std::unique_ptr<class GpuTimer> probeBakeGpuTimer_;
+		std::unique_ptr<TimelineSemaphore> probeBakeSemaphore_;
+		std::unique_ptr<TimelineSemaphore> probeReadSemaphore_;
+		std::vector<uint64_t> probeBakeImageValues_;
+		uint64_t probeBakeValue_{};
+		uint64_t probeReadValue_{};
+		VkPipelineStageFlags probeWaitStages_{};
+		bool isProbeFrame_{};
+		bool isProbeBakeRecorded_{};
+		bool isProbeBakeHeld_{};
+		bool hasProbeBakeTimes_{};
+
+		// Probe uploads and read backs recorded into a frame (e.g. when the cascades scroll), applied by the host once
+		// probeReadSemaphore_ reaches probeTransferValue_, the value signalled by that frame. There is a single transfer in
+		// flight: the cascades only scroll and the probes only page in and out again once it has been applied.
+		std::unique_ptr<class ProbeTransfer> probeTransfer_;
+		std::function<void(VkCommandBuffer, const ProbeTransfer&)> applyProbeTransfer_;
+		uint64_t probeTransferValue_{};
+
+		uint64_t probeBakeBudget = 16 * 1024 * 1024;
+		uint32_t probeUpdateCount = 0;
+		uint32_t probeUpdateSamples = 4;
+		float probeHysteresis = 0.97f;
+		bool isProbeCacheOutdated = false;
+		bool isProbeFilteringOutdated = false;
 		uint32_t numOfProbe;
 		bool ShowLightProbeTexture = false;
 		bool ShowOriginalRaytrace = false;
+		bool ProbeSHShading = false;
+		bool RasterisedPrimary = false;
+		bool RayQuery = false;
+		bool hasRayQuery_ = false;
+		bool TemporalAccumulation = false;
 		uint32_t currentProbeIndex = 0;
 	};
 
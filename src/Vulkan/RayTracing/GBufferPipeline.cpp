@@ -0,0 +1,303 @@
+#include "GBufferPipeline.hpp"
+#include "Assets/Scene.hpp"
+#include "Assets/UniformBuffer.hpp"
+#include "Assets/Vertex.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/DepthBuffer.hpp"
+#include "Vulkan/DescriptorBinding.hpp"
+#include "Vulkan/DescriptorSetManager.hpp"
+#include "Vulkan/DescriptorSets.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/ShaderModule.hpp"
+#include "Vulkan/SwapChain.hpp"
+#include <array>
+
+namespace Vulkan::RayTracing {
+
+	GBufferPipeline::GBufferPipeline(
+		const SwapChain& swapChain,
+		const DepthBuffer& depthBuffer,
+		const std::vector<Assets::UniformBuffer>& uniformBuffers,
+		const Assets::Scene& scene,
+		const ImageView& gBufferDepthImageView,
+		const ImageView& gBufferNormalImageView,
+		const ImageView& gBufferAlbedoImageView) :
+		swapChain_(swapChain)
+	{
+		const auto& device = swapChain.Device();
+
+		// Render pass: the G-buffer images, cleared to a miss, and the depth buffer.
+		const std::array<VkFormat, 3> colorFormats = { VK_FORMAT_R32_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT };
+		std::array<VkAttachmentDescription, AttachmentCount> attachments = {};
+		std::array<VkAttachmentReference, 3> colorAttachmentRefs = {};
+
+		for (uint32_t i = 0; i != colorFormats.size(); ++i)
+		{
+			auto& colorAttachment = attachments[i];
+			colorAttachment.format = colorFormats[i];
+			colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+			colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			colorAttachment.finalLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			colorAttachmentRefs[i].attachment = i;
+			colorAttachmentRefs[i].layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+
+		auto& depthAttachment = attachments[3];
+		depthAttachment.format = depthBuffer.Format();
+		depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference depthAttachmentRef = {};
+		depthAttachmentRef.attachment = 3;
+		depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = static_cast<uint32_t>(colorAttachmentRefs.size());
+		subpass.pColorAttachments = colorAttachmentRefs.data();
+		subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+		// The previous frame's gather may still read the G-buffer, and this frame's gather reads it once written.
+		std::array<VkSubpassDependency, 2> dependencies = {};
+		dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[0].dstSubpass = 0;
+		dependencies[0].srcStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[0].srcAccessMask = 0;
+		dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+		dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+		dependencies[1].srcSubpass = 0;
+		dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		dependencies[1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+		VkRenderPassCreateInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+		renderPassInfo.pAttachments = attachments.data();
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+		renderPassInfo.pDependencies = dependencies.data();
+
+		Check(vkCreateRenderPass(device.Handle(), &renderPassInfo, nullptr, &renderPass_),
+			"create G-buffer render pass");
+
+		const std::array<VkImageView, AttachmentCount> attachmentViews =
+		{
+			gBufferDepthImageView.Handle(),
+			gBufferNormalImageView.Handle(),
+			gBufferAlbedoImageView.Handle(),
+			depthBuffer.ImageView().Handle()
+		};
+
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = renderPass_;
+		framebufferInfo.attachmentCount = static_cast<uint32_t>(attachmentViews.size());
+		framebufferInfo.pAttachments = attachmentViews.data();
+		framebufferInfo.width = swapChain.Extent().width;
+		framebufferInfo.height = swapChain.Extent().height;
+		framebufferInfo.layers = 1;
+
+		Check(vkCreateFramebuffer(device.Handle(), &framebufferInfo, nullptr, &framebuffer_),
+			"create G-buffer framebuffer");
+
+		// Fixed function state, as in GraphicsPipeline, except that nothing is culled (the rays hit both sides).
+		const auto bindingDescription = Assets::Vertex::GetBindingDescription();
+		const auto attributeDescriptions = Assets::Vertex::GetAttributeDescriptions();
+
+		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
+		vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		vertexInputInfo.vertexBindingDescriptionCount = 1;
+		vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+		vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+		vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+
+		VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+		inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		inputAssembly.primitiveRestartEnable = VK_FALSE;
+
+		VkViewport viewport = {};
+		viewport.x = 0.0f;
+		viewport.y = 0.0f;
+		viewport.width = static_cast<float>(swapChain.Extent().width);
+		viewport.height = static_cast<float>(swapChain.Extent().height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		VkRect2D scissor = {};
+		scissor.offset = { 0, 0 };
+		scissor.extent = swapChain.Extent();
+
+		VkPipelineViewportStateCreateInfo viewportState = {};
+		viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		viewportState.viewportCount = 1;
+		viewportState.pViewports = &viewport;
+		viewportState.scissorCount = 1;
+		viewportState.pScissors = &scissor;
+
+		VkPipelineRasterizationStateCreateInfo rasterizer = {};
+		rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		rasterizer.depthClampEnable = VK_FALSE;
+		rasterizer.rasterizerDiscardEnable = VK_FALSE;
+		rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+		rasterizer.lineWidth = 1.0f;
+		rasterizer.cullMode = VK_CULL_MODE_NONE;
+		rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		rasterizer.depthBiasEnable = VK_FALSE;
+
+		VkPipelineMultisampleStateCreateInfo multisampling = {};
+		multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		multisampling.sampleShadingEnable = VK_FALSE;
+		multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+		depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+		depthStencil.depthTestEnable = VK_TRUE;
+		depthStencil.depthWriteEnable = VK_TRUE;
+		depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+		depthStencil.depthBoundsTestEnable = VK_FALSE;
+		depthStencil.stencilTestEnable = VK_FALSE;
+
+		std::array<VkPipelineColorBlendAttachmentState, 3> colorBlendAttachments = {};
+
+		for (auto& colorBlendAttachment : colorBlendAttachments)
+		{
+			colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			colorBlendAttachment.blendEnable = VK_FALSE;
+		}
+
+		VkPipelineColorBlendStateCreateInfo colorBlending = {};
+		colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		colorBlending.logicOpEnable = VK_FALSE;
+		colorBlending.attachmentCount = static_cast<uint32_t>(colorBlendAttachments.size());
+		colorBlending.pAttachments = colorBlendAttachments.data();
+
+		// Create descriptor pool/sets.
+		const std::vector<DescriptorBinding> descriptorBindings =
+		{
+			{0, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT},
+			{1, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT},
+			{2, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT}
+		};
+
+		descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+
+		auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+		for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
+		{
+			// Uniform buffer
+			VkDescriptorBufferInfo uniformBufferInfo = {};
+			uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
+			uniformBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Material buffer
+			VkDescriptorBufferInfo materialBufferInfo = {};
+			materialBufferInfo.buffer = scene.MaterialBuffer().Handle();
+			materialBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Image and texture samplers
+			std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
+
+			for (size_t t = 0; t != imageInfos.size(); ++t)
+			{
+				auto& imageInfo = imageInfos[t];
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = scene.TextureImageViews()[t];
+				imageInfo.sampler = scene.TextureSamplers()[t];
+			}
+
+			const std::vector<VkWriteDescriptorSet> descriptorWrites =
+			{
+				descriptorSets.Bind(i, 0, uniformBufferInfo),
+				descriptorSets.Bind(i, 1, materialBufferInfo),
+				descriptorSets.Bind(i, 2, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
+			};
+
+			descriptorSets.UpdateDescriptors(i, descriptorWrites);
+		}
+
+		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+
+		// Load shaders.
+		const ShaderModule vertShader(device, "../assets/shaders/GBuffer.vert.spv");
+		const ShaderModule fragShader(device, "../assets/shaders/GBuffer.frag.spv");
+
+		VkPipelineShaderStageCreateInfo shaderStages[] =
+		{
+			vertShader.CreateShaderStage(VK_SHADER_STAGE_VERTEX_BIT),
+			fragShader.CreateShaderStage(VK_SHADER_STAGE_FRAGMENT_BIT)
+		};
+
+		// Create graphic pipeline
+		VkGraphicsPipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		pipelineInfo.stageCount = 2;
+		pipelineInfo.pStages = shaderStages;
+		pipelineInfo.pVertexInputState = &vertexInputInfo;
+		pipelineInfo.pInputAssemblyState = &inputAssembly;
+		pipelineInfo.pViewportState = &viewportState;
+		pipelineInfo.pRasterizationState = &rasterizer;
+		pipelineInfo.pMultisampleState = &multisampling;
+		pipelineInfo.pDepthStencilState = &depthStencil;
+		pipelineInfo.pColorBlendState = &colorBlending;
+		pipelineInfo.pDynamicState = nullptr;
+		pipelineInfo.basePipelineHandle = nullptr;
+		pipelineInfo.basePipelineIndex = -1;
+		pipelineInfo.layout = pipelineLayout_->Handle();
+		pipelineInfo.renderPass = renderPass_;
+		pipelineInfo.subpass = 0;
+
+		Check(vkCreateGraphicsPipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+			"create G-buffer pipeline");
+	}
+
+	GBufferPipeline::~GBufferPipeline()
+	{
+		const auto device = swapChain_.Device().Handle();
+
+		if (pipeline_ != nullptr)
+		{
+			vkDestroyPipeline(device, pipeline_, nullptr);
+			pipeline_ = nullptr;
+		}
+
+		if (framebuffer_ != nullptr)
+		{
+			vkDestroyFramebuffer(device, framebuffer_, nullptr);
+			framebuffer_ = nullptr;
+		}
+
+		if (renderPass_ != nullptr)
+		{
+			vkDestroyRenderPass(device, renderPass_, nullptr);
+			renderPass_ = nullptr;
+		}
+
+		pipelineLayout_.reset();
+		descriptorSetManager_.reset();
+	}
+
+	VkDescriptorSet GBufferPipeline::DescriptorSet(const uint32_t index) const
+	{
+		return descriptorSetManager_->DescriptorSets().Handle(index);
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <memory>
+#include <vector>
+
+namespace Assets
+{
+	class Scene;
+	class UniformBuffer;
+}
+
+namespace Vulkan
+{
+	class DepthBuffer;
+	class DescriptorSetManager;
+	class ImageView;
+	class PipelineLayout;
+	class SwapChain;
+}
+
+namespace Vulkan::RayTracing
+{
+	// Graphics pipeline rasterising the primary visibility into the G-buffer of the probe-shaded mode (see GBuffer.frag),
+	// in place of the G-buffer raygen. Owns the render pass and framebuffer over the G-buffer images and the depth buffer;
+	// the G-buffer images are left in the general layout for ProbeGatherPipeline.
+	class GBufferPipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(GBufferPipeline)
+
+		GBufferPipeline(
+			const SwapChain& swapChain,
+			const DepthBuffer& depthBuffer,
+			const std::vector<Assets::UniformBuffer>& uniformBuffers,
+			const Assets::Scene& scene,
+			const ImageView& gBufferDepthImageView,
+			const ImageView& gBufferNormalImageView,
+			const ImageView& gBufferAlbedoImageView);
+
+		~GBufferPipeline();
+
+		static constexpr uint32_t AttachmentCount = 4; // depth, normal, albedo, depth buffer
+
+		VkDescriptorSet DescriptorSet(uint32_t index) const;
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+		VkRenderPass RenderPassHandle() const { return renderPass_; }
+		VkFramebuffer FramebufferHandle() const { return framebuffer_; }
+
+	private:
+
+		const SwapChain& swapChain_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+
+		VkRenderPass renderPass_{};
+		VkFramebuffer framebuffer_{};
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+	};
+
+}
@@ -0,0 +1,325 @@
+#include "LightProbeAtlas.hpp"
+#include "Utilities/Exception.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/CommandPool.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/DeviceMemory.hpp"
+#include "Vulkan/Image.hpp"
+#include "Vulkan/ImageMemoryBarrier.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/Sampler.hpp"
+#include "Vulkan/SingleTimeCommands.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace Vulkan::RayTracing {
+
+namespace
+{
+	template <class TSamplerConfig>
+	void CreateProbeTexture(
+		ProbeTexture& texture,
+		const Device& device,
+		const char* const name,
+		const VkExtent2D extent,
+		const uint32_t probeCount,
+		const VkFormat format,
+		const VkFormat storageFormat,
+		const uint32_t texelSize,
+		const VkImageUsageFlags usage,
+		const TSamplerConfig& samplerConfig)
+	{
+		VkFormatProperties formatProperties;
+		vkGetPhysicalDeviceFormatProperties(device.PhysicalDevice(), format, &formatProperties);
+
+		const VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+		if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+		{
+			Throw(std::runtime_error(std::string(name) + " format cannot be sampled with linear filtering on this device"));
+		}
+
+		// Writing through a view in another format needs a mutable format, and the extended usage lets the image
+		// have the storage usage even though only the storage view format supports it.
+		const bool isAliased = storageFormat != format;
+		const VkImageCreateFlags flags = isAliased ? VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT | VK_IMAGE_CREATE_EXTENDED_USAGE_BIT : 0;
+		const VkImageUsageFlags sampledUsage = isAliased ? VK_IMAGE_USAGE_SAMPLED_BIT : 0;
+		const VkImageUsageFlags storageUsage = isAliased ? VK_IMAGE_USAGE_STORAGE_BIT : 0;
+
+		// Baked on the compute queue, filtered and sampled on the graphics one.
+		texture.probeImage.reset(new Image(device, extent, probeCount, format, VK_IMAGE_TILING_OPTIMAL, usage, flags, VK_SHARING_MODE_CONCURRENT));
+		texture.probeImageMemory.reset(new DeviceMemory(texture.probeImage->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+		texture.probeImageView.reset(new ImageView(device, texture.probeImage->Handle(), format, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, probeCount, sampledUsage));
+		texture.probeStorageView.reset(new ImageView(device, texture.probeImage->Handle(), storageFormat, VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, probeCount, storageUsage));
+		texture.probeSampler.reset(new Sampler(device, samplerConfig));
+		texture.texelSize = texelSize;
+
+		const auto& debugUtils = device.DebugUtils();
+
+		debugUtils.SetObjectName(texture.probeImage->Handle(), (std::string(name) + " Image").c_str());
+		debugUtils.SetObjectName(texture.probeImageMemory->Handle(), (std::string(name) + " Image Memory").c_str());
+		debugUtils.SetObjectName(texture.probeImageView->Handle(), (std::string(name) + " ImageView").c_str());
+		debugUtils.SetObjectName(texture.probeStorageView->Handle(), (std::string(name) + " Storage ImageView").c_str());
+	}
+
+	void TransferBarrier(
+		VkCommandBuffer commandBuffer,
+		const VkPipelineStageFlags srcStage, const VkAccessFlags srcAccess,
+		const VkPipelineStageFlags dstStage, const VkAccessFlags dstAccess)
+	{
+		VkMemoryBarrier memoryBarrier = {};
+		memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		memoryBarrier.pNext = nullptr;
+		memoryBarrier.srcAccessMask = srcAccess;
+		memoryBarrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	VkExtent2D LayerExtent(const uint32_t resolution)
+	{
+		return { resolution + 2 * LightProbeAtlas::Gutter, resolution + 2 * LightProbeAtlas::Gutter };
+	}
+
+	VkBufferImageCopy LayersRegion(const Image& image, const VkDeviceSize bufferOffset, const uint32_t firstLayer, const uint32_t layerCount)
+	{
+		VkBufferImageCopy region = {};
+		region.bufferOffset = bufferOffset;
+		region.bufferRowLength = 0;
+		region.bufferImageHeight = 0;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = 0;
+		region.imageSubresource.baseArrayLayer = firstLayer;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageOffset = { 0, 0, 0 };
+		region.imageExtent = { image.Extent().width, image.Extent().height, 1 };
+		return region;
+	}
+
+	VkBufferImageCopy AllLayersRegion(const Image& image)
+	{
+		return LayersRegion(image, 0, 0, image.ArrayLayers());
+	}
+
+	// Regions of the given layers of the baked maps, in a buffer holding one page per layer (each page being the layer
+	// of every map, one after the other).
+	std::vector<std::vector<VkBufferImageCopy>> PageRegions(
+		const std::vector<const ProbeTexture*>& textures,
+		const std::vector<uint32_t>& layers,
+		const VkDeviceSize pageSize)
+	{
+		std::vector<std::vector<VkBufferImageCopy>> regions(textures.size());
+		VkDeviceSize textureOffset = 0;
+
+		for (size_t t = 0; t != textures.size(); ++t)
+		{
+			for (size_t i = 0; i != layers.size(); ++i)
+			{
+				regions[t].push_back(LayersRegion(*textures[t]->probeImage, i * pageSize + textureOffset, layers[i], 1));
+			}
+
+			textureOffset += textures[t]->LayerByteSize();
+		}
+
+		return regions;
+	}
+}
+
+VkDeviceSize ProbeTexture::ByteSize() const
+{
+	return LayerByteSize() * probeImage->ArrayLayers();
+}
+
+VkDeviceSize ProbeTexture::LayerByteSize() const
+{
+	const auto extent = probeImage->Extent();
+	return static_cast<VkDeviceSize>(extent.width) * extent.height * texelSize;
+}
+
+LightProbeAtlas::LightProbeAtlas(const Device& device, const LightProbeConfig& config, const uint32_t probeCount) :
+	probeCount_(probeCount)
+{
+	// Each resident probe is a layer of every map.
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device.PhysicalDevice(), &properties);
+
+	if (probeCount > properties.limits.maxImageArrayLayers)
+	{
+		Throw(std::runtime_error("the light probe atlas needs " + std::to_string(probeCount) + " image array layers, the device only supports " +
+			std::to_string(properties.limits.maxImageArrayLayers) + " (see --probe-max-count and --probe-resident-count)"));
+	}
+
+	const auto usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+	CreateProbeTexture(radiance_, device, "Light Probe Radiance", LayerExtent(config.RadianceResolution), probeCount, config.RadianceFormat, config.RadianceStorageFormat(), config.RadianceTexelSize(), usage, RadianceSampler());
+	// Distances are kept in full precision: squared distances overflow half floats in the larger scenes (e.g. Cornell box).
+	CreateProbeTexture(sphericalDistances_, device, "Light Probe Spherical Distances", LayerExtent(config.DepthResolution), probeCount, VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32_SFLOAT, 4, usage, SphericalSampler());
+	CreateProbeTexture(squaredDistances_, device, "Light Probe Squared Distances", LayerExtent(config.DepthResolution), probeCount, VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32_SFLOAT, 4, usage, SquaredSampler());
+
+	// The glossy levels are derived from the radiance after each bake or update, they only need to be written and sampled.
+	const auto glossyResolution = config.GlossyResolution;
+	if (glossyResolution == 0 || (glossyResolution & (glossyResolution - 1)) != 0 || config.GlossyLevels == 0 || (glossyResolution >> (config.GlossyLevels - 1)) == 0)
+	{
+		Throw(std::invalid_argument("invalid light probe glossy resolution or level count"));
+	}
+
+	CreateProbeTexture(glossy_, device, "Light Probe Glossy Radiance", { config.GlossyWidth(), config.GlossyHeight() }, probeCount,
+		VK_FORMAT_R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, 8, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, RadianceSampler());
+}
+
+LightProbeAtlas::~LightProbeAtlas()
+{
+	for (auto* texture : { &radiance_, &sphericalDistances_, &squaredDistances_, &glossy_ })
+	{
+		texture->probeSampler.reset();
+		texture->probeStorageView.reset();
+		texture->probeImageView.reset();
+		texture->probeImage.reset();
+		texture->probeImageMemory.reset();
+	}
+}
+
+void LightProbeAtlas::TransitionToGeneral(VkCommandBuffer commandBuffer) const
+{
+	VkImageSubresourceRange subresourceRange = {};
+	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	subresourceRange.baseMipLevel = 0;
+	subresourceRange.levelCount = 1;
+	subresourceRange.baseArrayLayer = 0;
+	subresourceRange.layerCount = probeCount_;
+
+	for (const auto* texture : { &radiance_, &sphericalDistances_, &squaredDistances_, &glossy_ })
+	{
+		ImageMemoryBarrier::Insert(commandBuffer, texture->probeImage->Handle(), subresourceRange, 0,
+			VK_ACCESS_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	}
+}
+
+std::vector<uint8_t> LightProbeAtlas::Download(CommandPool& commandPool, const ProbeTexture& texture) const
+{
+	const auto size = texture.ByteSize();
+	const auto& device = commandPool.Device();
+
+	auto stagingBuffer = std::make_unique<Buffer>(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
+	{
+		const auto region = AllLayersRegion(*texture.probeImage);
+
+		TransferBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_SHADER_WRITE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+		vkCmdCopyImageToBuffer(commandBuffer, texture.probeImage->Handle(), VK_IMAGE_LAYOUT_GENERAL, stagingBuffer->Handle(), 1, &region);
+
+		TransferBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+	});
+
+	std::vector<uint8_t> data(size);
+
+	const auto mapped = stagingBufferMemory.Map(0, size);
+	std::memcpy(data.data(), mapped, size);
+	stagingBufferMemory.Unmap();
+
+	// Delete the buffer before the memory
+	stagingBuffer.reset();
+
+	return data;
+}
+
+void LightProbeAtlas::Upload(CommandPool& commandPool, const ProbeTexture& texture, const std::vector<uint8_t>& data) const
+{
+	const auto size = texture.ByteSize();
+	const auto& device = commandPool.Device();
+
+	if (data.size() != size)
+	{
+		Throw(std::invalid_argument("light probe data size does not match the probe atlas"));
+	}
+
+	auto stagingBuffer = std::make_unique<Buffer>(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	auto stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+	const auto mapped = stagingBufferMemory.Map(0, size);
+	std::memcpy(mapped, data.data(), size);
+	stagingBufferMemory.Unmap();
+
+	SingleTimeCommands::Submit(commandPool, [&](VkCommandBuffer commandBuffer)
+	{
+		const auto region = AllLayersRegion(*texture.probeImage);
+
+		TransferBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+		vkCmdCopyBufferToImage(commandBuffer, stagingBuffer->Handle(), texture.probeImage->Handle(), VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+
+		TransferBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+	});
+
+	// Delete the buffer before the memory
+	stagingBuffer.reset();
+}
+
+VkDeviceSize LightProbeAtlas::PageSize() const
+{
+	return radiance_.LayerByteSize() + sphericalDistances_.LayerByteSize() + squaredDistances_.LayerByteSize();
+}
+
+void LightProbeAtlas::CopyLayersToBuffer(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& layers, const Buffer& buffer) const
+{
+	if (layers.empty())
+	{
+		return;
+	}
+
+	const std::vector<const ProbeTexture*> textures = { &radiance_, &sphericalDistances_, &squaredDistances_ };
+	const auto regions = PageRegions(textures, layers, PageSize());
+
+	TransferBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+	for (size_t t = 0; t != textures.size(); ++t)
+	{
+		vkCmdCopyImageToBuffer(commandBuffer, textures[t]->probeImage->Handle(), VK_IMAGE_LAYOUT_GENERAL, buffer.Handle(),
+			static_cast<uint32_t>(regions[t].size()), regions[t].data());
+	}
+
+	TransferBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT);
+}
+
+void LightProbeAtlas::CopyLayersFromBuffer(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& layers, const Buffer& buffer) const
+{
+	if (layers.empty())
+	{
+		return;
+	}
+
+	const std::vector<const ProbeTexture*> textures = { &radiance_, &sphericalDistances_, &squaredDistances_ };
+	const auto regions = PageRegions(textures, layers, PageSize());
+
+	// The layers may have just been copied out, to page out the probe they held.
+	TransferBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+	for (size_t t = 0; t != textures.size(); ++t)
+	{
+		vkCmdCopyBufferToImage(commandBuffer, buffer.Handle(), textures[t]->probeImage->Handle(), VK_IMAGE_LAYOUT_GENERAL,
+			static_cast<uint32_t>(regions[t].size()), regions[t].data());
+	}
+
+	TransferBarrier(commandBuffer,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "LightProbeConfig.hpp"
+#include "Vulkan/Vulkan.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Buffer;
+	class CommandPool;
+	class Device;
+	class DeviceMemory;
+	class Image;
+	class ImageView;
+	class Sampler;
+}
+
+namespace Vulkan::RayTracing
+{
+	struct ProbeTexture
+	{
+
+		std::unique_ptr<Image> probeImage;
+		std::unique_ptr<DeviceMemory> probeImageMemory;
+		std::unique_ptr<ImageView> probeImageView;
+		std::unique_ptr<ImageView> probeStorageView; // written by the bake, may alias the texels with another format
+		std::unique_ptr<Sampler> probeSampler;
+		uint32_t texelSize;
+
+		const Vulkan::Sampler& Sampler() const { return *probeSampler; }
+
+		// Size of all the layers, tightly packed.
+		VkDeviceSize ByteSize() const;
+		VkDeviceSize LayerByteSize() const;
+	};
+
+	// Octahedral maps of all the resident light probes, one 2D array image per data type with one layer per probe slot
+	// (see LightProbeResidency).
+	// Each layer holds the probe map surrounded by a one texel gutter that duplicates the opposite octahedral
+	// edge, so that bilinear filtering is seamless across the octahedral folds.
+	class LightProbeAtlas final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(LightProbeAtlas)
+
+		LightProbeAtlas(const Device& device, const LightProbeConfig& config, uint32_t probeCount);
+		~LightProbeAtlas();
+
+		static const uint32_t Gutter = 1;
+
+		uint32_t ProbeCount() const { return probeCount_; }
+
+		// Mean radiance, and mean and mean squared distance to the nearest geometry (for Chebyshev visibility).
+		const ProbeTexture& Radiance() const { return radiance_; }
+		const ProbeTexture& SphericalDistances() const { return sphericalDistances_; }
+		const ProbeTexture& SquaredDistances() const { return squaredDistances_; }
+
+		// Radiance prefiltered for increasing fuzziness (see LightProbeConfig::GlossyLevels), derived from the radiance map.
+		const ProbeTexture& Glossy() const { return glossy_; }
+
+		// Transition every layer of every map to the general layout, used by both the bake and the shading.
+		void TransitionToGeneral(VkCommandBuffer commandBuffer) const;
+
+		// Copy all the layers of a map from/to host memory (synchronous, e.g. for the probe cache).
+		std::vector<uint8_t> Download(CommandPool& commandPool, const ProbeTexture& texture) const;
+		void Upload(CommandPool& commandPool, const ProbeTexture& texture, const std::vector<uint8_t>& data) const;
+
+		// Size of the baked maps (radiance and distances) of a layer, the page of a probe paged out of the atlas.
+		VkDeviceSize PageSize() const;
+
+		// Record the copies of the baked maps of some layers to/from a buffer holding one page per layer (e.g. to page
+		// probes out of and into the atlas within a frame).
+		void CopyLayersToBuffer(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& layers, const Buffer& buffer) const;
+		void CopyLayersFromBuffer(VkCommandBuffer commandBuffer, const std::vector<uint32_t>& layers, const Buffer& buffer) const;
+
+	private:
+
+		const uint32_t probeCount_;
+
+		ProbeTexture radiance_;
+		ProbeTexture sphericalDistances_;
+		ProbeTexture squaredDistances_;
+		ProbeTexture glossy_;
+	};
+
+}
@@ -0,0 +1,277 @@
+#include "LightProbeCache.hpp"
+#include "LightProbe.hpp"
+#include "LightProbeAtlas.hpp"
+#include "Assets/Model.hpp"
+#include "Assets/Scene.hpp"
+#include "Assets/Texture.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace Vulkan::RayTracing {
+
+namespace
+{
+	const uint32_t Magic = 0x4250474C; // "LGPB"
+	const uint32_t Version = 3;
+
+	// Part of the cache key, bump it whenever a change to the bake shaders changes the baked probes.
+	const uint32_t BakeVersion = 1;
+
+	// 64-bit FNV-1a.
+	class Hash final
+	{
+	public:
+
+		template <class T>
+		void Add(const T& value)
+		{
+			const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+
+			for (size_t i = 0; i != sizeof(T); ++i)
+			{
+				value_ = (value_ ^ bytes[i]) * 0x100000001B3ull;
+			}
+		}
+
+		uint64_t Value() const { return value_; }
+
+	private:
+
+		uint64_t value_ = 0xCBF29CE484222325ull;
+	};
+
+	// Everything that the bake result (or the probe placement) depends on, written at the start of the cache file.
+	struct Header final
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint32_t RadianceResolution;
+		uint32_t DepthResolution;
+		uint32_t RadianceFormat;
+		uint32_t SamplesPerTexel;
+		uint32_t Bounces;
+		uint32_t ProbeCount;
+		glm::vec3 GridOrigin;
+		glm::vec3 GridSpacing;
+		glm::uvec3 GridCount;
+	};
+
+	Header MakeHeader(const uint64_t key, const LightProbeConfig& config, const LightProbeGrid& grid)
+	{
+		Header header = {};
+		header.Magic = Magic;
+		header.Version = Version;
+		header.Key = key;
+		header.RadianceResolution = config.RadianceResolution;
+		header.DepthResolution = config.DepthResolution;
+		header.RadianceFormat = static_cast<uint32_t>(config.RadianceFormat);
+		header.SamplesPerTexel = config.SamplesPerTexel;
+		header.Bounces = config.Bounces;
+		header.ProbeCount = grid.ProbeCount();
+		header.GridOrigin = grid.Origin;
+		header.GridSpacing = grid.Spacing;
+		header.GridCount = grid.Count;
+		return header;
+	}
+
+	// The probes are relocated off their grid position (see LightProbeRelocation.rgen), the bake depends on where they ended up.
+	std::vector<glm::vec4> ProbePositions(const std::vector<LightProbe>& probes)
+	{
+		std::vector<glm::vec4> positions;
+		positions.reserve(probes.size());
+
+		for (const auto& probe : probes)
+		{
+			positions.emplace_back(probe.position, 1.0f);
+		}
+
+		return positions;
+	}
+
+	template <class T>
+	void WriteVector(std::ofstream& file, const std::vector<T>& content)
+	{
+		const uint64_t size = content.size();
+		file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+		file.write(reinterpret_cast<const char*>(content.data()), size * sizeof(T));
+	}
+
+	template <class T>
+	bool ReadVector(std::ifstream& file, std::vector<T>& content)
+	{
+		uint64_t size = 0;
+
+		if (!file.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > (1ull << 34))
+		{
+			return false;
+		}
+
+		content.resize(size);
+		return static_cast<bool>(file.read(reinterpret_cast<char*>(content.data()), size * sizeof(T)));
+	}
+}
+
+LightProbeCache::LightProbeCache(const Assets::Scene& scene, const bool hasSky, const LightProbeConfig& config) :
+	config_(config)
+{
+	Hash hash;
+
+	hash.Add(BakeVersion);
+
+	for (const auto& model : scene.Models())
+	{
+		hash.Add(model.NumberOfVertices());
+		hash.Add(model.NumberOfIndices());
+		hash.Add(model.NumberOfMaterials());
+
+		// The model transforms are already applied to the vertices.
+		for (const auto& vertex : model.Vertices())
+		{
+			hash.Add(vertex.Position);
+			hash.Add(vertex.Normal);
+			hash.Add(vertex.TexCoord);
+			hash.Add(vertex.MaterialIndex);
+		}
+
+		for (const auto index : model.Indices())
+		{
+			hash.Add(index);
+		}
+
+		for (const auto& material : model.Materials())
+		{
+			hash.Add(material.Diffuse);
+			hash.Add(material.DiffuseTextureId);
+			hash.Add(material.Fuzziness);
+			hash.Add(material.RefractionIndex);
+			hash.Add(material.MaterialModel);
+		}
+
+		if (model.Procedural())
+		{
+			const auto box = model.Procedural()->BoundingBox();
+			hash.Add(box.first);
+			hash.Add(box.second);
+		}
+	}
+
+	for (const auto& texture : scene.Textures())
+	{
+		hash.Add(texture.Width());
+		hash.Add(texture.Height());
+
+		const auto* pixels = texture.Pixels();
+		const size_t size = static_cast<size_t>(texture.Width()) * texture.Height() * 4;
+
+		for (size_t i = 0; i != size; ++i)
+		{
+			hash.Add(pixels[i]);
+		}
+	}
+
+	hash.Add(hasSky);
+	hash.Add(config.RadianceResolution);
+	hash.Add(config.DepthResolution);
+	hash.Add(config.RadianceFormat);
+	hash.Add(config.SamplesPerTexel);
+	hash.Add(config.Bounces);
+	hash.Add(config.AdaptiveThreshold);
+	hash.Add(config.AdaptiveMinSamples);
+	hash.Add(config.AdaptiveMaxScale);
+	hash.Add(config.ProbeSpacing);
+	hash.Add(config.MaxProbeCount);
+	hash.Add(config.RelocationRayCount);
+	hash.Add(config.RelocationIterations);
+	hash.Add(config.RelocationMaxOffset);
+
+	key_ = hash.Value();
+
+	std::ostringstream path;
+	path << config.CacheDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << key_ << ".probes";
+	path_ = path.str();
+}
+
+bool LightProbeCache::Load(CommandPool& commandPool, const LightProbeGrid& grid, const std::vector<LightProbe>& probes, const std::vector<uint32_t>& states, const LightProbeAtlas& atlas) const
+{
+	std::ifstream file(path_, std::ios::binary);
+
+	if (!file)
+	{
+		return false;
+	}
+
+	const Header expected = MakeHeader(key_, config_, grid);
+	Header header = {};
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+		header.Magic != expected.Magic ||
+		header.Version != expected.Version ||
+		header.Key != expected.Key ||
+		header.RadianceResolution != expected.RadianceResolution ||
+		header.DepthResolution != expected.DepthResolution ||
+		header.RadianceFormat != expected.RadianceFormat ||
+		header.SamplesPerTexel != expected.SamplesPerTexel ||
+		header.Bounces != expected.Bounces ||
+		header.ProbeCount != expected.ProbeCount ||
+		header.GridOrigin != expected.GridOrigin ||
+		header.GridSpacing != expected.GridSpacing ||
+		header.GridCount != expected.GridCount)
+	{
+		return false;
+	}
+
+	std::vector<glm::vec4> positions;
+	std::vector<uint32_t> cachedStates;
+	std::vector<uint8_t> radiance;
+	std::vector<uint8_t> sphericalDistances;
+	std::vector<uint8_t> squaredDistances;
+
+	if (!ReadVector(file, positions) ||
+		!ReadVector(file, cachedStates) ||
+		!ReadVector(file, radiance) ||
+		!ReadVector(file, sphericalDistances) ||
+		!ReadVector(file, squaredDistances) ||
+		positions != ProbePositions(probes) ||
+		cachedStates != states ||
+		radiance.size() != atlas.Radiance().ByteSize() ||
+		sphericalDistances.size() != atlas.SphericalDistances().ByteSize() ||
+		squaredDistances.size() != atlas.SquaredDistances().ByteSize())
+	{
+		return false;
+	}
+
+	atlas.Upload(commandPool, atlas.Radiance(), radiance);
+	atlas.Upload(commandPool, atlas.SphericalDistances(), sphericalDistances);
+	atlas.Upload(commandPool, atlas.SquaredDistances(), squaredDistances);
+
+	return true;
+}
+
+void LightProbeCache::Save(CommandPool& commandPool, const LightProbeGrid& grid, const std::vector<LightProbe>& probes, const std::vector<uint32_t>& states, const LightProbeAtlas& atlas) const
+{
+	std::error_code error;
+	std::filesystem::create_directories(config_.CacheDirectory, error);
+
+	std::ofstream file(path_, std::ios::binary | std::ios::trunc);
+
+	if (!file)
+	{
+		std::cerr << "WARNING: cannot write light probe cache '" << path_ << "'" << std::endl;
+		return;
+	}
+
+	const Header header = MakeHeader(key_, config_, grid);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	WriteVector(file, ProbePositions(probes));
+	WriteVector(file, states);
+	WriteVector(file, atlas.Download(commandPool, atlas.Radiance()));
+	WriteVector(file, atlas.Download(commandPool, atlas.SphericalDistances()));
+	WriteVector(file, atlas.Download(commandPool, atlas.SquaredDistances()));
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "LightProbeConfig.hpp"
+#include "LightProbeGrid.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Assets
+{
+	class Scene;
+}
+
+namespace Vulkan
+{
+	class CommandPool;
+}
+
+namespace Vulkan::RayTracing
+{
+	class LightProbe;
+	class LightProbeAtlas;
+
+	// On-disk cache of the baked light probes. There is one file per scene and bake configuration, named after a hash of
+	// the scene content (geometry, materials, textures, procedurals, sky), of the LightProbeConfig and of the bake shaders
+	// version. It holds the bake settings, the probe grid, positions and states, followed by the radiance and distance atlases.
+	class LightProbeCache final
+	{
+	public:
+
+		LightProbeCache(const Assets::Scene& scene, bool hasSky, const LightProbeConfig& config);
+		~LightProbeCache() = default;
+
+		const std::string& Path() const { return path_; }
+
+		// Returns false if there is no matching cache file, in which case the probes need to be baked.
+		bool Load(CommandPool& commandPool, const LightProbeGrid& grid, const std::vector<LightProbe>& probes, const std::vector<uint32_t>& states, const LightProbeAtlas& atlas) const;
+		void Save(CommandPool& commandPool, const LightProbeGrid& grid, const std::vector<LightProbe>& probes, const std::vector<uint32_t>& states, const LightProbeAtlas& atlas) const;
+
+	private:
+
+		const LightProbeConfig config_;
+		uint64_t key_{};
+		std::string path_;
+	};
+
+}
@@ -0,0 +1,106 @@
+#include "LightProbeCascades.hpp"
+#include <cmath>
+
+namespace Vulkan::RayTracing {
+
+LightProbeCascades::LightProbeCascades(const LightProbeGrid& grid) :
+	grids_{ grid }
+{
+}
+
+LightProbeCascades::LightProbeCascades(const uint32_t cascadeCount, const uint32_t resolution, const float spacing, const glm::vec3& cameraPosition) :
+	isScrolling_(true)
+{
+	uint32_t firstProbe = 0;
+
+	for (uint32_t i = 0; i != cascadeCount; ++i)
+	{
+		LightProbeGrid grid;
+		grid.Spacing = glm::vec3(spacing * static_cast<float>(1u << i));
+		grid.Count = glm::uvec3(resolution);
+		grid.FirstProbe = firstProbe;
+		grid.Scroll = CentredScroll(grid, cameraPosition);
+		grid.Origin = grid.Spacing * glm::vec3(grid.Scroll);
+
+		firstProbe += grid.ProbeCount();
+		grids_.push_back(grid);
+	}
+}
+
+uint32_t LightProbeCascades::ProbeCount() const
+{
+	const auto& last = grids_.back();
+	return last.FirstProbe + last.ProbeCount();
+}
+
+glm::vec3 LightProbeCascades::ProbePosition(const uint32_t probeIndex) const
+{
+	for (const auto& grid : grids_)
+	{
+		if (probeIndex < grid.FirstProbe + grid.ProbeCount())
+		{
+			return grid.ProbePosition(probeIndex - grid.FirstProbe);
+		}
+	}
+
+	return grids_.back().ProbePosition(grids_.back().ProbeCount() - 1);
+}
+
+std::vector<uint32_t> LightProbeCascades::Scroll(const glm::vec3& cameraPosition)
+{
+	std::vector<uint32_t> moved;
+
+	if (!isScrolling_)
+	{
+		return moved;
+	}
+
+	for (auto& grid : grids_)
+	{
+		const glm::ivec3 scroll = CentredScroll(grid, cameraPosition);
+
+		if (scroll == grid.Scroll)
+		{
+			continue;
+		}
+
+		// A probe keeps its slot as long as its world grid coordinate stays inside the grid.
+		for (uint32_t i = 0; i != grid.ProbeCount(); ++i)
+		{
+			const glm::ivec3 slot(i % grid.Count.x, (i / grid.Count.x) % grid.Count.y, i / (grid.Count.x * grid.Count.y));
+
+			if (grid.Wrap(slot - grid.Scroll) + grid.Scroll != grid.Wrap(slot - scroll) + scroll)
+			{
+				moved.push_back(grid.FirstProbe + i);
+			}
+		}
+
+		grid.Scroll = scroll;
+		grid.Origin = grid.Spacing * glm::vec3(grid.Scroll);
+	}
+
+	return moved;
+}
+
+LightProbeCascadesUniform LightProbeCascades::Uniform() const
+{
+	LightProbeCascadesUniform uniform = {};
+
+	for (size_t i = 0; i != grids_.size(); ++i)
+	{
+		uniform.Grids[i] = LightProbeGridUniform(grids_[i]);
+	}
+
+	uniform.CascadeCount = glm::uvec4(static_cast<uint32_t>(grids_.size()), 0, 0, 0);
+
+	return uniform;
+}
+
+glm::ivec3 LightProbeCascades::CentredScroll(const LightProbeGrid& grid, const glm::vec3& cameraPosition) const
+{
+	// The camera is in the central cell of the grid.
+	const glm::ivec3 cameraCoord(glm::floor(cameraPosition / grid.Spacing));
+	return cameraCoord - glm::ivec3(grid.Count - 1u) / 2;
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "LightProbeGrid.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Vulkan::RayTracing
+{
+	// The probe grids of the scene, indexed as a single range of probes: either one grid fitted to the scene,
+	// or nested grids (probe clipmaps) centred on the camera, the finest first. The cascades scroll with the camera
+	// in whole probe steps, and thanks to their toroidal addressing only the probes entering a grid move to a new position,
+	// so that the bake cost and the number of probes stay bounded however large the scene is.
+	class LightProbeCascades final
+	{
+	public:
+
+		explicit LightProbeCascades(const LightProbeGrid& grid);
+		LightProbeCascades(uint32_t cascadeCount, uint32_t resolution, float spacing, const glm::vec3& cameraPosition);
+		~LightProbeCascades() = default;
+
+		const std::vector<LightProbeGrid>& Grids() const { return grids_; }
+		bool IsScrolling() const { return isScrolling_; }
+
+		uint32_t ProbeCount() const;
+		glm::vec3 ProbePosition(uint32_t probeIndex) const;
+
+		// Recentres the cascades on the camera, and returns the probes that moved (to be relocated and baked again).
+		std::vector<uint32_t> Scroll(const glm::vec3& cameraPosition);
+
+		LightProbeCascadesUniform Uniform() const;
+
+	private:
+
+		glm::ivec3 CentredScroll(const LightProbeGrid& grid, const glm::vec3& cameraPosition) const;
+
+		std::vector<LightProbeGrid> grids_;
+		bool isScrolling_{};
+	};
+
+}
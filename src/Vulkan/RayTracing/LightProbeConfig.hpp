@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <string>
+
+namespace Vulkan::RayTracing
+{
+	// Placement, size, texel format, sample count and caching of the light probes. Small octahedral maps (DDGI-style 8x8 to 64x64)
+	// are usually enough for diffuse lighting and cost a fraction of the memory and bake time of large ones.
+	// The radiance is linear HDR: the packed float formats keep it at 4 bytes per texel.
+	struct LightProbeConfig final
+	{
+		uint32_t RadianceResolution = 64;
+		uint32_t DepthResolution = 16;
+		VkFormat RadianceFormat = VK_FORMAT_E5B9G9R9_UFLOAT_PACK32;
+		uint32_t SamplesPerTexel = 500;
+		uint32_t Bounces = 16;
+
+		// Adaptive bake: a radiance texel stops sampling once the 95% confidence interval of its mean luminance is narrower than
+		// AdaptiveThreshold times the mean, after AdaptiveMinSamples at least. SamplesPerTexel is then the average budget of a texel,
+		// and the rays saved on the converged texels go to the noisier ones, up to AdaptiveMaxScale times SamplesPerTexel.
+		float AdaptiveThreshold = 0.05f; // 0 = every texel takes SamplesPerTexel samples
+		uint32_t AdaptiveMinSamples = 32;
+		uint32_t AdaptiveMaxScale = 4;
+
+		float ProbeSpacing = 0.0f; // 0 = derived from the scene volume and MaxProbeCount
+		uint32_t MaxProbeCount = 512;
+
+		// Instead of a single grid fitted to the scene, nested grids of CascadeResolution^3 probes centred on the camera
+		// (see LightProbeCascades). The finest is ProbeSpacing apart (1 if automatic), and each next one doubles the spacing.
+		uint32_t Cascades = 0; // 0 = a single grid fitted to the scene
+		uint32_t CascadeResolution = 8;
+		static constexpr uint32_t MaxCascades = 4;
+
+		// Number of probes resident in the probe atlas, the closest ones to the camera (see LightProbeResidency).
+		// The other probes are paged out to host memory, so the probe count is not bounded by the GPU memory anymore.
+		uint32_t ResidentProbeCount = 0; // 0 = all the probes are resident
+
+		// After the placement, a ray traced pass moves the probes out of the nearby geometry (see LightProbeRelocation.rgen):
+		// each iteration traces RelocationRayCount rays per probe, and a probe never moves further than RelocationMaxOffset
+		// times the spacing from its grid position. The probes still inside geometry after the last iteration are deactivated.
+		uint32_t RelocationRayCount = 64;
+		uint32_t RelocationIterations = 4;
+		float RelocationMaxOffset = 0.45f;
+
+		std::string CacheDirectory; // empty = the bake is not cached
+
+		// Radiance prefiltered for glossy reflections: level k is blurred for a fuzziness of k / (GlossyLevels - 1),
+		// at a resolution of GlossyResolution >> k (a power of two). The levels sit side by side in each probe layer.
+		uint32_t GlossyResolution = 32;
+		uint32_t GlossyLevels = 5;
+
+		// L2 spherical harmonics irradiance of a probe: 9 RGB coefficients (see LightProbe.glsl).
+		static constexpr uint32_t SHFloats = 9 * 3;
+
+		uint32_t RadianceTexels() const { return RadianceResolution * RadianceResolution; }
+		uint32_t MaxSamplesPerTexel() const { return AdaptiveThreshold > 0.0f ? SamplesPerTexel * AdaptiveMaxScale : SamplesPerTexel; }
+		uint32_t DepthTexels() const { return DepthResolution * DepthResolution; }
+
+		// Horizontal offset of a glossy level in its probe layer, each level having its own gutter (see ProbeGlossyUV).
+		uint32_t GlossyLevelOffset(const uint32_t level) const { return 2 * GlossyResolution - 2 * (GlossyResolution >> level) + 2 * level; }
+		uint32_t GlossyWidth() const { return GlossyLevelOffset(GlossyLevels); }
+		uint32_t GlossyHeight() const { return GlossyResolution + 2; }
+
+		uint32_t RadianceTexelSize() const
+		{
+			switch (RadianceFormat)
+			{
+			case VK_FORMAT_R32G32B32A32_SFLOAT: return 16;
+			case VK_FORMAT_R16G16B16A16_SFLOAT: return 8;
+			default: return 4;
+			}
+		}
+
+		// The packed formats cannot be written by a shader, so the bake writes all the radiance formats through an unsigned
+		// integer view of the same texel size, and packs the texels itself (see ProbeEncodeRadiance in LightProbe.glsl).
+		VkFormat RadianceStorageFormat() const
+		{
+			switch (RadianceFormat)
+			{
+			case VK_FORMAT_R32G32B32A32_SFLOAT: return VK_FORMAT_R32G32B32A32_UINT;
+			case VK_FORMAT_R16G16B16A16_SFLOAT: return VK_FORMAT_R32G32_UINT;
+			default: return VK_FORMAT_R32_UINT;
+			}
+		}
+
+		// Matches the ProbeEncoding constants in LightProbe.glsl.
+		uint32_t RadianceEncoding() const
+		{
+			switch (RadianceFormat)
+			{
+			case VK_FORMAT_R32G32B32A32_SFLOAT: return 1;
+			case VK_FORMAT_R8G8B8A8_UNORM: return 2;
+			case VK_FORMAT_B10G11R11_UFLOAT_PACK32: return 3;
+			case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32: return 4;
+			default: return 0; // VK_FORMAT_R16G16B16A16_SFLOAT
+			}
+		}
+	};
+}
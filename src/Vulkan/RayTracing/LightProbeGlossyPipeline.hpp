@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include "LightProbeConfig.hpp"
+#include <memory>
+
+namespace Vulkan
+{
+	class Buffer;
+	class DescriptorSetManager;
+	class Device;
+	class PipelineLayout;
+}
+
+namespace Vulkan::RayTracing
+{
+	class LightProbeAtlas;
+
+	// Compute pipeline prefiltering the baked probe radiance for glossy reflections (see LightProbeGlossy.comp).
+	// Dispatch one workgroup per active probe for each level in turn, the level being pushed as a constant.
+	class LightProbeGlossyPipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(LightProbeGlossyPipeline)
+
+		LightProbeGlossyPipeline(
+			const Device& device,
+			const LightProbeConfig& lightProbeConfig,
+			const LightProbeAtlas& lightProbeAtlas,
+			const std::unique_ptr<Buffer>& lightProbePosBuffer);
+
+		~LightProbeGlossyPipeline();
+
+		VkDescriptorSet DescriptorSet() const;
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+
+	private:
+
+		const Device& device_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+	};
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "LightProbeConfig.hpp"
+#include "Utilities/Glm.hpp"
+#include <cstdint>
+
+namespace Vulkan::RayTracing
+{
+	// Regular 3D grid of light probes. Probe (x, y, z) sits at Origin + Spacing * (x, y, z) and is stored at index
+	// x + Count.x * (y + Count.y * z), so that the 8 probes surrounding any point are found arithmetically.
+	// Grids that scroll (see LightProbeCascades) use toroidal addressing instead: the probe at world grid coordinate
+	// Scroll + (x, y, z) is stored at the index of its coordinate modulo Count, and the grid probes start at FirstProbe.
+	struct LightProbeGrid final
+	{
+		glm::vec3 Origin{};
+		glm::vec3 Spacing{ 1.0f };
+		glm::uvec3 Count{ 1 };
+		glm::ivec3 Scroll{};
+		uint32_t FirstProbe{};
+
+		uint32_t ProbeCount() const { return Count.x * Count.y * Count.z; }
+
+		// Position of the probe stored at the given index of the grid (from 0 to ProbeCount()).
+		glm::vec3 ProbePosition(const uint32_t index) const
+		{
+			const glm::ivec3 slot(index % Count.x, (index / Count.x) % Count.y, index / (Count.x * Count.y));
+			return Origin + Spacing * glm::vec3(Wrap(slot - Scroll));
+		}
+
+		glm::ivec3 Wrap(const glm::ivec3& coord) const
+		{
+			const glm::ivec3 count(Count);
+			return ((coord % count) + count) % count;
+		}
+	};
+
+	// std140 layout of the grid, as read by the shaders.
+	struct LightProbeGridUniform final
+	{
+		glm::vec4 Origin;
+		glm::vec4 Spacing;
+		glm::uvec4 Count;
+		glm::ivec4 Scroll;
+
+		LightProbeGridUniform() = default;
+
+		explicit LightProbeGridUniform(const LightProbeGrid& grid) :
+			Origin(grid.Origin, 0.0f),
+			Spacing(grid.Spacing, 0.0f),
+			Count(grid.Count, grid.ProbeCount()),
+			Scroll(grid.Scroll, static_cast<int32_t>(grid.FirstProbe))
+		{
+		}
+	};
+
+	// std140 layout of all the grids (LightProbeCascadesUniform in LightProbe.glsl).
+	struct LightProbeCascadesUniform final
+	{
+		LightProbeGridUniform Grids[LightProbeConfig::MaxCascades];
+		glm::uvec4 CascadeCount;
+	};
+}
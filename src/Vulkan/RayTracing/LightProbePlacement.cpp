@@ -0,0 +1,322 @@
+#include "LightProbePlacement.hpp"
+#include "Assets/Model.hpp"
+#include "Assets/Scene.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Vulkan::RayTracing {
+
+namespace
+{
+	// Models much larger than the rest of the scene (e.g. the RTIOW ground sphere) only block probes,
+	// they do not extend the probe volume.
+	const float BackdropScale = 10.0f;
+
+	struct Bounds final
+	{
+		glm::vec3 Min{ std::numeric_limits<float>::max() };
+		glm::vec3 Max{ std::numeric_limits<float>::lowest() };
+
+		bool IsEmpty() const { return Min.x > Max.x; }
+		float Diagonal() const { return IsEmpty() ? 0.0f : glm::length(Max - Min); }
+
+		void Add(const glm::vec3& point)
+		{
+			Min = glm::min(Min, point);
+			Max = glm::max(Max, point);
+		}
+
+		void Add(const Bounds& bounds)
+		{
+			if (!bounds.IsEmpty())
+			{
+				Add(bounds.Min);
+				Add(bounds.Max);
+			}
+		}
+	};
+
+	Bounds ModelBounds(const Assets::Model& model)
+	{
+		Bounds bounds;
+
+		if (model.Procedural())
+		{
+			const auto box = model.Procedural()->BoundingBox();
+			bounds.Add(box.first);
+			bounds.Add(box.second);
+			return bounds;
+		}
+
+		for (const auto& vertex : model.Vertices())
+		{
+			bounds.Add(vertex.Position);
+		}
+
+		return bounds;
+	}
+
+	Bounds SceneBounds(const std::vector<Bounds>& modelBounds)
+	{
+		Bounds bounds;
+
+		for (size_t i = 0; i != modelBounds.size(); ++i)
+		{
+			Bounds others;
+
+			for (size_t j = 0; j != modelBounds.size(); ++j)
+			{
+				if (j != i)
+				{
+					others.Add(modelBounds[j]);
+				}
+			}
+
+			if (others.IsEmpty() || modelBounds[i].Diagonal() <= BackdropScale * others.Diagonal())
+			{
+				bounds.Add(modelBounds[i]);
+			}
+		}
+
+		return bounds;
+	}
+
+	LightProbeGrid FitGrid(const Bounds& bounds, const LightProbeConfig& config)
+	{
+		LightProbeGrid grid;
+
+		if (bounds.IsEmpty())
+		{
+			return grid;
+		}
+
+		const glm::vec3 extent = bounds.Max - bounds.Min;
+		const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+		const auto countFor = [&](const float spacing)
+		{
+			return glm::max(glm::ceil(extent / spacing), glm::vec3(1.0f));
+		};
+
+		float spacing = config.ProbeSpacing;
+
+		if (spacing <= 0.0f)
+		{
+			// Spread the probes evenly over the scene volume.
+			const float volume = std::max(extent.x * extent.y * extent.z, 0.0f);
+			spacing = std::max(std::cbrt(volume / config.MaxProbeCount), maxExtent / config.MaxProbeCount);
+			spacing = spacing > 0.0f ? spacing : 1.0f;
+		}
+
+		for (auto count = countFor(spacing); double(count.x) * count.y * count.z > config.MaxProbeCount; count = countFor(spacing))
+		{
+			spacing *= 1.05f;
+		}
+
+		// Centre the grid in the bounds, so that the outer probes are not sitting on the outer walls.
+		grid.Count = glm::uvec3(countFor(spacing));
+		grid.Spacing = glm::vec3(spacing);
+		grid.Origin = 0.5f * (bounds.Min + bounds.Max) - 0.5f * grid.Spacing * glm::vec3(grid.Count - 1u);
+
+		return grid;
+	}
+
+	enum class Voxel : uint8_t
+	{
+		Empty,
+		Solid,
+		Outside
+	};
+
+	class VoxelGrid final
+	{
+	public:
+
+		// The voxels are half the probe spacing, and the probes sit on even voxel centres.
+		// Two border voxels on each side are always beyond the scene bounds, and seed the flood fill.
+		static constexpr int Border = 2;
+
+		explicit VoxelGrid(const LightProbeGrid& grid) :
+			size_(grid.Spacing.x * 0.5f),
+			origin_(grid.Origin - size_ * Border),
+			dims_(2 * glm::ivec3(grid.Count - 1u) + 1 + 2 * Border),
+			voxels_(static_cast<size_t>(dims_.x) * dims_.y * dims_.z, Voxel::Empty)
+		{
+		}
+
+		Voxel At(const glm::ivec3& coord) const { return voxels_[Index(coord)]; }
+		Voxel AtProbe(const glm::uvec3& probeCoord) const { return At(2 * glm::ivec3(probeCoord) + Border); }
+
+		void MarkPoint(const glm::vec3& point)
+		{
+			const auto coord = glm::ivec3(glm::round((point - origin_) / size_));
+
+			if (Contains(coord))
+			{
+				voxels_[Index(coord)] = Voxel::Solid;
+			}
+		}
+
+		void MarkTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+		{
+			// Sample the triangle densely enough to touch every voxel it crosses.
+			const float maxEdge = std::max(glm::length(b - a), std::max(glm::length(c - b), glm::length(a - c)));
+			const int n = std::max(1, static_cast<int>(std::ceil(maxEdge / (0.5f * size_))));
+
+			for (int i = 0; i <= n; ++i)
+			{
+				for (int j = 0; j <= n - i; ++j)
+				{
+					MarkPoint(a + (b - a) * (static_cast<float>(i) / n) + (c - a) * (static_cast<float>(j) / n));
+				}
+			}
+		}
+
+		void MarkProcedural(const Assets::Procedural& procedural)
+		{
+			const auto box = procedural.BoundingBox();
+			const auto first = glm::max(glm::ivec3(glm::floor((box.first - origin_) / size_)), glm::ivec3(0));
+			const auto last = glm::min(glm::ivec3(glm::ceil((box.second - origin_) / size_)), dims_ - 1);
+
+			for (int z = first.z; z <= last.z; ++z)
+			{
+				for (int y = first.y; y <= last.y; ++y)
+				{
+					for (int x = first.x; x <= last.x; ++x)
+					{
+						if (procedural.Contains(origin_ + size_ * glm::vec3(x, y, z)))
+						{
+							voxels_[Index({ x, y, z })] = Voxel::Solid;
+						}
+					}
+				}
+			}
+
+			// Procedurals smaller than a voxel still occupy the one containing their centre.
+			MarkPoint(0.5f * (box.first + box.second));
+		}
+
+		// Flags every empty voxel reachable from the border, the remaining empty voxels are enclosed by geometry.
+		void FloodFillOutside()
+		{
+			std::vector<glm::ivec3> stack;
+
+			for (int z = 0; z != dims_.z; ++z)
+			{
+				for (int y = 0; y != dims_.y; ++y)
+				{
+					for (int x = 0; x != dims_.x; ++x)
+					{
+						if (x == 0 || y == 0 || z == 0 || x == dims_.x - 1 || y == dims_.y - 1 || z == dims_.z - 1)
+						{
+							stack.emplace_back(x, y, z);
+						}
+					}
+				}
+			}
+
+			const glm::ivec3 neighbours[] = { {1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1} };
+
+			while (!stack.empty())
+			{
+				const auto coord = stack.back();
+				stack.pop_back();
+
+				if (!Contains(coord) || voxels_[Index(coord)] != Voxel::Empty)
+				{
+					continue;
+				}
+
+				voxels_[Index(coord)] = Voxel::Outside;
+
+				for (const auto& neighbour : neighbours)
+				{
+					stack.push_back(coord + neighbour);
+				}
+			}
+		}
+
+	private:
+
+		bool Contains(const glm::ivec3& coord) const
+		{
+			return glm::all(glm::greaterThanEqual(coord, glm::ivec3(0))) && glm::all(glm::lessThan(coord, dims_));
+		}
+
+		size_t Index(const glm::ivec3& coord) const
+		{
+			return (static_cast<size_t>(coord.z) * dims_.y + coord.y) * dims_.x + coord.x;
+		}
+
+		const float size_;
+		const glm::vec3 origin_;
+		const glm::ivec3 dims_;
+		std::vector<Voxel> voxels_;
+	};
+}
+
+LightProbePlacement::LightProbePlacement(const Assets::Scene& scene, const LightProbeConfig& config)
+{
+	std::vector<Bounds> modelBounds;
+
+	for (const auto& model : scene.Models())
+	{
+		modelBounds.push_back(ModelBounds(model));
+	}
+
+	grid_ = FitGrid(SceneBounds(modelBounds), config);
+
+	// Voxelise the scene.
+	VoxelGrid voxels(grid_);
+
+	for (const auto& model : scene.Models())
+	{
+		if (model.Procedural())
+		{
+			voxels.MarkProcedural(*model.Procedural());
+			continue;
+		}
+
+		const auto& vertices = model.Vertices();
+		const auto& indices = model.Indices();
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			voxels.MarkTriangle(vertices[indices[i + 0]].Position, vertices[indices[i + 1]].Position, vertices[indices[i + 2]].Position);
+		}
+	}
+
+	voxels.FloodFillOutside();
+
+	// Keep the probes lying outside of the geometry. If none does (e.g. a fully closed room),
+	// fall back to only dropping the ones touching the geometry, and then to keeping them all.
+	const uint32_t probeCount = grid_.ProbeCount();
+
+	for (const auto keep : { Voxel::Outside, Voxel::Empty })
+	{
+		states_.assign(probeCount, 0);
+		activeProbeCount_ = 0;
+
+		for (uint32_t i = 0; i != probeCount; ++i)
+		{
+			const glm::uvec3 coord(i % grid_.Count.x, (i / grid_.Count.x) % grid_.Count.y, i / (grid_.Count.x * grid_.Count.y));
+			const auto voxel = voxels.AtProbe(coord);
+
+			if (voxel == Voxel::Outside || voxel == keep)
+			{
+				states_[i] = 1;
+				activeProbeCount_++;
+			}
+		}
+
+		if (activeProbeCount_ != 0)
+		{
+			return;
+		}
+	}
+
+	states_.assign(probeCount, 1);
+	activeProbeCount_ = probeCount;
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "LightProbeConfig.hpp"
+#include "LightProbeGrid.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace Assets
+{
+	class Scene;
+}
+
+namespace Vulkan::RayTracing
+{
+	// Fits a probe grid to the scene geometry and drops the probes embedded in it.
+	// The scene is voxelised at half the probe spacing: voxels touched by a triangle or inside a procedural are solid,
+	// and empty voxels that cannot be reached from outside the scene (e.g. inside a closed mesh) are solid too.
+	class LightProbePlacement final
+	{
+	public:
+
+		LightProbePlacement(const Assets::Scene& scene, const LightProbeConfig& config);
+		~LightProbePlacement() = default;
+
+		const LightProbeGrid& Grid() const { return grid_; }
+
+		// One entry per grid probe, 1 if the probe is active and 0 if it is embedded in geometry.
+		const std::vector<uint32_t>& States() const { return states_; }
+		uint32_t ActiveProbeCount() const { return activeProbeCount_; }
+
+	private:
+
+		LightProbeGrid grid_;
+		std::vector<uint32_t> states_;
+		uint32_t activeProbeCount_{};
+	};
+
+}
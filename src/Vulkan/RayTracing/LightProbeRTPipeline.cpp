@@ -12,171 +12,222 @@
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
 #include "Vulkan/ShaderModule.hpp"
-#include "Vulkan/SwapChain.hpp"
+#include <cstddef>
 
 namespace Vulkan::RayTracing {
 
 	LightProbeRTPipeline::LightProbeRTPipeline(
 		const DeviceProcedures& deviceProcedures,
-		const SwapChain& swapChain,
 		const TopLevelAccelerationStructure& accelerationStructure,
-		const ImageView& accumulationImageView,
-		const ImageView& outputImageView,
 		const std::vector<Assets::UniformBuffer>& uniformBuffers,
 		const Assets::Scene& scene,
-		const std::vector<LightProbe>& lightProbes,
-		const std::unique_ptr<Buffer>& lightProbePosBuffer) :
-		swapChain_(swapChain)
+		const LightProbeConfig& lightProbeConfig,
+		const LightProbeAtlas& lightProbeAtlas,
+		const std::unique_ptr<Buffer>& lightProbePosBuffer,
+		const std::unique_ptr<Buffer>& lightProbeStatisticsBuffer,
+		const std::vector<std::unique_ptr<Buffer>>& lightProbeActiveTexelBuffers,
+		const bool rayQuery) :
+		device_(deviceProcedures.Device())
 	{
-		// Create descriptor pool/sets.
-		const auto& device = swapChain.Device();
+		// Create descriptor pool/sets, one per uniform buffer, shared with the ray query compute pipeline.
+		const auto& device = device_;
 		const std::vector<DescriptorBinding> descriptorBindings =
 		{
 			// Top level acceleration structure.
-			{0, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+			{0, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Camera information & co
-			{1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR},
+			{1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Vertex buffer, Index buffer, Material buffer, Offset buffer
-			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{3, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{3, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Textures and image samplers
-			{6, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+			{6, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			//Light probes positions
 			{7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,VK_SHADER_STAGE_RAYGEN_BIT_KHR },
 
-			// Light probe textures
-			{8, static_cast<uint32_t>(lightProbes.size()), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
-			{9, static_cast<uint32_t>(lightProbes.size()), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
-			{10, static_cast<uint32_t>(lightProbes.size()), VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+			// Light probe atlas (radiance, spherical distances, squared distances)
+			{8, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{9, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{10, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 			// The Procedural buffer.
-			{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR}
+			{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Emissive triangles (next-event estimation)
+			{12, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Adaptive bake: per texel statistics, and count of the texels still sampled (one counter per frame)
+			{13, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{14, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT}
 		};
 
 		descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
 
 		auto& descriptorSets = descriptorSetManager_->DescriptorSets();
 
-		// Top level acceleration structure.
-		const auto accelerationStructureHandle = accelerationStructure.Handle();
-		VkWriteDescriptorSetAccelerationStructureKHR structureInfo = {};
-		structureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
-		structureInfo.pNext = nullptr;
-		structureInfo.accelerationStructureCount = 1;
-		structureInfo.pAccelerationStructures = &accelerationStructureHandle;
-
-		std::vector<VkDescriptorImageInfo> radianceInfo(lightProbes.size());
-		std::vector<VkDescriptorImageInfo> sphericalInfo(lightProbes.size());
-		std::vector<VkDescriptorImageInfo> squaredInfo(lightProbes.size());
-
-		for (size_t i = 0; i < lightProbes.size(); i++)
+		for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
 		{
-			auto& rInfo = radianceInfo[i];
-			auto& sInfo = sphericalInfo[i];
-			auto& sqInfo = squaredInfo[i];
-
-			rInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-			rInfo.imageView = lightProbes[i].radianceDistribution->probeImageView->Handle();
-
-
-			sInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-			sInfo.imageView = lightProbes[i].sphericalDistances->probeImageView->Handle();
-
-
-			sqInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-			sqInfo.imageView = lightProbes[i].squaredDistances->probeImageView->Handle();
+			// Top level acceleration structure.
+			const auto accelerationStructureHandle = accelerationStructure.Handle();
+			VkWriteDescriptorSetAccelerationStructureKHR structureInfo = {};
+			structureInfo.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
+			structureInfo.pNext = nullptr;
+			structureInfo.accelerationStructureCount = 1;
+			structureInfo.pAccelerationStructures = &accelerationStructureHandle;
+
+			// Light probe atlas
+			VkDescriptorImageInfo radianceInfo = {};
+			radianceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			radianceInfo.imageView = lightProbeAtlas.Radiance().probeStorageView->Handle();
+
+			VkDescriptorImageInfo sphericalInfo = {};
+			sphericalInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			sphericalInfo.imageView = lightProbeAtlas.SphericalDistances().probeStorageView->Handle();
+
+			VkDescriptorImageInfo squaredInfo = {};
+			squaredInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			squaredInfo.imageView = lightProbeAtlas.SquaredDistances().probeStorageView->Handle();
+
+			// Uniform buffer
+			VkDescriptorBufferInfo uniformBufferInfo = {};
+			uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
+			uniformBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Vertex buffer
+			VkDescriptorBufferInfo vertexBufferInfo = {};
+			vertexBufferInfo.buffer = scene.VertexBuffer().Handle();
+			vertexBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Index buffer
+			VkDescriptorBufferInfo indexBufferInfo = {};
+			indexBufferInfo.buffer = scene.IndexBuffer().Handle();
+			indexBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Material buffer
+			VkDescriptorBufferInfo materialBufferInfo = {};
+			materialBufferInfo.buffer = scene.MaterialBuffer().Handle();
+			materialBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Offsets buffer
+			VkDescriptorBufferInfo offsetsBufferInfo = {};
+			offsetsBufferInfo.buffer = scene.OffsetsBuffer().Handle();
+			offsetsBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Light probes buffer
+			VkDescriptorBufferInfo lightProbePosBufferInfo = {};
+			lightProbePosBufferInfo.buffer = lightProbePosBuffer->Handle();
+			lightProbePosBufferInfo.range = VK_WHOLE_SIZE;
+
+
+			// Emitter buffer
+			VkDescriptorBufferInfo emitterBufferInfo = {};
+			emitterBufferInfo.buffer = scene.EmitterBuffer().Handle();
+			emitterBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Adaptive bake buffers
+			VkDescriptorBufferInfo lightProbeStatisticsBufferInfo = {};
+			lightProbeStatisticsBufferInfo.buffer = lightProbeStatisticsBuffer->Handle();
+			lightProbeStatisticsBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightProbeActiveTexelBufferInfo = {};
+			lightProbeActiveTexelBufferInfo.buffer = lightProbeActiveTexelBuffers[i]->Handle();
+			lightProbeActiveTexelBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Image and texture samplers.
+			std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
+
+			for (size_t t = 0; t != imageInfos.size(); ++t)
+			{
+				auto& imageInfo = imageInfos[t];
+				imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				imageInfo.imageView = scene.TextureImageViews()[t];
+				imageInfo.sampler = scene.TextureSamplers()[t];
+			}
+
+			std::vector<VkWriteDescriptorSet> descriptorWrites =
+			{
+				descriptorSets.Bind(i, 0, structureInfo),
+				descriptorSets.Bind(i, 1, uniformBufferInfo),
+				descriptorSets.Bind(i, 2, vertexBufferInfo),
+				descriptorSets.Bind(i, 3, indexBufferInfo),
+				descriptorSets.Bind(i, 4, materialBufferInfo),
+				descriptorSets.Bind(i, 5, offsetsBufferInfo),
+				descriptorSets.Bind(i, 6, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
+				descriptorSets.Bind(i, 7, lightProbePosBufferInfo),
+
+				descriptorSets.Bind(i, 8, radianceInfo),
+				descriptorSets.Bind(i, 9, sphericalInfo),
+				descriptorSets.Bind(i, 10, squaredInfo),
+				descriptorSets.Bind(i, 12, emitterBufferInfo),
+				descriptorSets.Bind(i, 13, lightProbeStatisticsBufferInfo),
+				descriptorSets.Bind(i, 14, lightProbeActiveTexelBufferInfo)
+			};
+
+			// Procedural buffer (optional)
+			VkDescriptorBufferInfo proceduralBufferInfo = {};
+
+			if (scene.HasProcedurals())
+			{
+				proceduralBufferInfo.buffer = scene.ProceduralBuffer().Handle();
+				proceduralBufferInfo.range = VK_WHOLE_SIZE;
+
+				descriptorWrites.push_back(descriptorSets.Bind(i, 11, proceduralBufferInfo));
+			}
+
+			descriptorSets.UpdateDescriptors(i, descriptorWrites);
 		}
 
+		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT));
 
-		// Uniform buffer
-		VkDescriptorBufferInfo uniformBufferInfo = {};
-		uniformBufferInfo.buffer = uniformBuffers[0].Buffer().Handle();
-		uniformBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Vertex buffer
-		VkDescriptorBufferInfo vertexBufferInfo = {};
-		vertexBufferInfo.buffer = scene.VertexBuffer().Handle();
-		vertexBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Index buffer
-		VkDescriptorBufferInfo indexBufferInfo = {};
-		indexBufferInfo.buffer = scene.IndexBuffer().Handle();
-		indexBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Material buffer
-		VkDescriptorBufferInfo materialBufferInfo = {};
-		materialBufferInfo.buffer = scene.MaterialBuffer().Handle();
-		materialBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Offsets buffer
-		VkDescriptorBufferInfo offsetsBufferInfo = {};
-		offsetsBufferInfo.buffer = scene.OffsetsBuffer().Handle();
-		offsetsBufferInfo.range = VK_WHOLE_SIZE;
-
-		// Light probes buffer
-		VkDescriptorBufferInfo lightProbePosBufferInfo = {};
-		lightProbePosBufferInfo.buffer = lightProbePosBuffer->Handle();
-		lightProbePosBufferInfo.range = VK_WHOLE_SIZE;
-
-
-		// Image and texture samplers.
-		std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
+		// Load shaders.
+		// TODO: load new shaders
+		const ShaderModule rayGenShader(device, "../assets/shaders/LightProbe.rgen.spv");
+		const ShaderModule missShader(device, "../assets/shaders/LightProbe.rmiss.spv");
+		const ShaderModule closestHitShader(device, "../assets/shaders/LightProbe.rchit.spv");
+		const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/LightProbe.Procedural.rchit.spv");
+		const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/LightProbe.Procedural.rint.spv");
 
-		for (size_t t = 0; t != imageInfos.size(); ++t)
+		// Specialise the bake raygen on the probe resolutions, bounce count, radiance encoding and adaptive sampling.
+		struct SpecializationData
 		{
-			auto& imageInfo = imageInfos[t];
-			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = scene.TextureImageViews()[t];
-			imageInfo.sampler = scene.TextureSamplers()[t];
-		}
+			uint32_t RadianceResolution;
+			uint32_t DepthResolution;
+			uint32_t Bounces;
+			uint32_t RadianceEncoding;
+			float AdaptiveThreshold;
+			uint32_t AdaptiveMinSamples;
+		};
 
-		std::vector<VkWriteDescriptorSet> descriptorWrites =
+		const SpecializationData specializationData =
 		{
-			descriptorSets.Bind(0, 0, structureInfo),
-			descriptorSets.Bind(0, 1, uniformBufferInfo),
-			descriptorSets.Bind(0, 2, vertexBufferInfo),
-			descriptorSets.Bind(0, 3, indexBufferInfo),
-			descriptorSets.Bind(0, 4, materialBufferInfo),
-			descriptorSets.Bind(0, 5, offsetsBufferInfo),
-			descriptorSets.Bind(0, 6, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
-			descriptorSets.Bind(0, 7, lightProbePosBufferInfo),
-
-			descriptorSets.Bind(0, 8, *radianceInfo.data(),static_cast<uint32_t>(radianceInfo.size())),
-			descriptorSets.Bind(0, 9, *sphericalInfo.data(),static_cast<uint32_t>(sphericalInfo.size())),
-			descriptorSets.Bind(0, 10, *squaredInfo.data(),static_cast<uint32_t>(squaredInfo.size()))
+			lightProbeConfig.RadianceResolution, lightProbeConfig.DepthResolution, lightProbeConfig.Bounces, lightProbeConfig.RadianceEncoding(),
+			lightProbeConfig.AdaptiveThreshold, lightProbeConfig.AdaptiveMinSamples
 		};
 
-		// Procedural buffer (optional)
-		VkDescriptorBufferInfo proceduralBufferInfo = {};
-
-		if (scene.HasProcedurals())
+		const VkSpecializationMapEntry specializationEntries[] =
 		{
-			proceduralBufferInfo.buffer = scene.ProceduralBuffer().Handle();
-			proceduralBufferInfo.range = VK_WHOLE_SIZE;
-
-			descriptorWrites.push_back(descriptorSets.Bind(0, 11, proceduralBufferInfo));
-		}
-
-		descriptorSets.UpdateDescriptors(0, descriptorWrites);
-
-		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+			{0, offsetof(SpecializationData, RadianceResolution), sizeof(uint32_t)},
+			{1, offsetof(SpecializationData, DepthResolution), sizeof(uint32_t)},
+			{2, offsetof(SpecializationData, Bounces), sizeof(uint32_t)},
+			{3, offsetof(SpecializationData, RadianceEncoding), sizeof(uint32_t)},
+			{4, offsetof(SpecializationData, AdaptiveThreshold), sizeof(float)},
+			{5, offsetof(SpecializationData, AdaptiveMinSamples), sizeof(uint32_t)}
+		};
 
-		// Load shaders.
-		// TODO: load new shaders
-		const ShaderModule rayGenShader(device, "../assets/shaders/LightProbe.rgen.spv");
-		const ShaderModule missShader(device, "../assets/shaders/LightProbe.rmiss.spv");
-		const ShaderModule closestHitShader(device, "../assets/shaders/LightProbe.rchit.spv");
-		const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/LightProbe.Procedural.rchit.spv");
-		const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/LightProbe.Procedural.rint.spv");
+		VkSpecializationInfo specializationInfo = {};
+		specializationInfo.mapEntryCount = 6;
+		specializationInfo.pMapEntries = specializationEntries;
+		specializationInfo.dataSize = sizeof(specializationData);
+		specializationInfo.pData = &specializationData;
 
 		std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
 		{
-			rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR),
+			rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR, &specializationInfo),
 			missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
 			closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
 			proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
@@ -250,13 +301,39 @@ namespace Vulkan::RayTracing {
 
 		Check(deviceProcedures.vkCreateRayTracingPipelinesKHR(device.Handle(), nullptr, nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
 			"create ray tracing pipeline");
+
+		// Inline ray query backend of the bake, with the same specialization.
+		if (!rayQuery)
+		{
+			return;
+		}
+
+		const ShaderModule rayQueryShader(device, "../assets/shaders/LightProbeRayQuery.comp.spv");
+
+		VkComputePipelineCreateInfo computePipelineInfo = {};
+		computePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		computePipelineInfo.pNext = nullptr;
+		computePipelineInfo.flags = 0;
+		computePipelineInfo.stage = rayQueryShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, &specializationInfo);
+		computePipelineInfo.layout = pipelineLayout_->Handle();
+		computePipelineInfo.basePipelineHandle = nullptr;
+		computePipelineInfo.basePipelineIndex = 0;
+
+		Check(vkCreateComputePipelines(device.Handle(), nullptr, 1, &computePipelineInfo, nullptr, &computePipeline_),
+			"create light probe ray query pipeline");
 	}
 
 	LightProbeRTPipeline::~LightProbeRTPipeline()
 	{
+		if (computePipeline_ != nullptr)
+		{
+			vkDestroyPipeline(device_.Handle(), computePipeline_, nullptr);
+			computePipeline_ = nullptr;
+		}
+
 		if (pipeline_ != nullptr)
 		{
-			vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
+			vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
 			pipeline_ = nullptr;
 		}
 
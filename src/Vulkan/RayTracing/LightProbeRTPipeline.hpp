@@ -3,7 +3,7 @@
 #include "Vulkan/Vulkan.hpp"
 #include <memory>
 #include <vector>
-#include "LightProbe.hpp"
+#include "LightProbeAtlas.hpp"
 #include "Vulkan/Buffer.hpp"
 
 namespace Assets
@@ -15,9 +15,8 @@ namespace Assets
 namespace Vulkan
 {
 	class DescriptorSetManager;
-	class ImageView;
+	class Device;
 	class PipelineLayout;
-	class SwapChain;
 }
 
 namespace Vulkan::RayTracing
@@ -33,14 +32,15 @@ namespace Vulkan::RayTracing
 
 			LightProbeRTPipeline(
 				const DeviceProcedures& deviceProcedures,
-				const SwapChain& swapChain,
 				const TopLevelAccelerationStructure& accelerationStructure,
-				const ImageView& accumulationImageView,
-				const ImageView& outputImageView,
 				const std::vector<Assets::UniformBuffer>& uniformBuffers,
 				const Assets::Scene& scene,
-				const std::vector<LightProbe>& lightProbes,
-				const std::unique_ptr<Buffer>& lightProbePosBuffer);
+				const LightProbeConfig& lightProbeConfig,
+				const LightProbeAtlas& lightProbeAtlas,
+				const std::unique_ptr<Buffer>& lightProbePosBuffer,
+				const std::unique_ptr<Buffer>& lightProbeStatisticsBuffer,
+				const std::vector<std::unique_ptr<Buffer>>& lightProbeActiveTexelBuffers,
+				bool rayQuery);
 
 		~LightProbeRTPipeline();
 
@@ -49,15 +49,22 @@ namespace Vulkan::RayTracing
 		uint32_t TriangleHitGroupIndex() const { return triangleHitGroupIndex_; }
 		uint32_t ProceduralHitGroupIndex() const { return proceduralHitGroupIndex_; }
 
+		// Inline ray query counterpart of the bake raygen (LightProbeRayQuery.comp), dispatched over 8x8 texel tiles.
+		// Only created if the device supports ray queries.
+		VkPipeline ComputePipelineHandle() const { return computePipeline_; }
+		static constexpr uint32_t ComputeTileSize = 8;
+
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 
 	private:
 
-		const SwapChain& swapChain_;
+		const Device& device_;
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
+		VkPipeline computePipeline_{};
+
 			std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<class PipelineLayout> pipelineLayout_;
 
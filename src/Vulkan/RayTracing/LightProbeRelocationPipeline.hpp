@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <memory>
+
+namespace Assets
+{
+	class Scene;
+}
+
+namespace Vulkan
+{
+	class Buffer;
+	class DescriptorSetManager;
+	class Device;
+	class PipelineLayout;
+}
+
+namespace Vulkan::RayTracing
+{
+	class DeviceProcedures;
+	class TopLevelAccelerationStructure;
+
+	// Ray tracing pipeline moving the light probes out of the geometry and classifying them (see LightProbeRelocation.rgen).
+	// It runs right after the probe placement on all the probes, then on the probes scrolling into a probe cascade:
+	// trace one launch per probe of the relocation list.
+	class LightProbeRelocationPipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(LightProbeRelocationPipeline)
+
+		LightProbeRelocationPipeline(
+			const DeviceProcedures& deviceProcedures,
+			const TopLevelAccelerationStructure& accelerationStructure,
+			const Assets::Scene& scene,
+			const std::unique_ptr<Buffer>& lightProbeGridBuffer,
+			const std::unique_ptr<Buffer>& lightProbeStateBuffer,
+			const std::unique_ptr<Buffer>& lightProbeOffsetBuffer,
+			const std::unique_ptr<Buffer>& lightProbeRelocationListBuffer);
+
+		~LightProbeRelocationPipeline();
+
+		uint32_t RayGenShaderIndex() const { return rayGenIndex_; }
+		uint32_t MissShaderIndex() const { return missIndex_; }
+		uint32_t TriangleHitGroupIndex() const { return triangleHitGroupIndex_; }
+		uint32_t ProceduralHitGroupIndex() const { return proceduralHitGroupIndex_; }
+
+		VkDescriptorSet DescriptorSet() const;
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+
+	private:
+
+		const Device& device_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+
+		uint32_t rayGenIndex_;
+		uint32_t missIndex_;
+		uint32_t triangleHitGroupIndex_;
+		uint32_t proceduralHitGroupIndex_;
+	};
+
+}
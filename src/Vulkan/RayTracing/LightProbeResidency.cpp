@@ -0,0 +1,114 @@
+#include "LightProbeResidency.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace Vulkan::RayTracing {
+
+LightProbeResidency::LightProbeResidency(const uint32_t probeCount, const uint32_t slotCount) :
+	slotCount_(std::min(slotCount, probeCount)),
+	slots_(probeCount, NotResident),
+	pages_(probeCount)
+{
+	// A pool holding every probe maps each probe to its own index, and never pages anything.
+	if (slotCount_ == probeCount)
+	{
+		for (uint32_t i = 0; i != probeCount; ++i)
+		{
+			slots_[i] = i;
+		}
+
+		return;
+	}
+
+	// Hand out the lowest slots first.
+	freeSlots_.resize(slotCount_);
+
+	for (uint32_t i = 0; i != slotCount_; ++i)
+	{
+		freeSlots_[i] = slotCount_ - 1 - i;
+	}
+}
+
+std::vector<ProbeResidencyChange> LightProbeResidency::Update(const std::vector<float>& priorities)
+{
+	if (IsComplete())
+	{
+		return {};
+	}
+
+	std::vector<uint32_t> candidates;
+
+	for (uint32_t probe = 0; probe != ProbeCount(); ++probe)
+	{
+		if (std::isfinite(priorities[probe]))
+		{
+			candidates.push_back(probe);
+		}
+	}
+
+	if (candidates.size() > slotCount_)
+	{
+		const auto rank = [&](const uint32_t probe) { return IsResident(probe) ? priorities[probe] * ResidentBias : priorities[probe]; };
+		std::nth_element(candidates.begin(), candidates.begin() + slotCount_, candidates.end(),
+			[&](const uint32_t a, const uint32_t b) { return rank(a) < rank(b); });
+
+		candidates.resize(slotCount_);
+		std::sort(candidates.begin(), candidates.end());
+	}
+
+	std::vector<bool> isWanted(ProbeCount(), false);
+
+	for (const auto probe : candidates)
+	{
+		isWanted[probe] = true;
+	}
+
+	std::vector<ProbeResidencyChange> changes;
+
+	for (uint32_t probe = 0; probe != ProbeCount(); ++probe)
+	{
+		if (IsResident(probe) && !isWanted[probe])
+		{
+			changes.push_back({ probe, slots_[probe], false });
+			freeSlots_.push_back(slots_[probe]);
+			slots_[probe] = NotResident;
+		}
+	}
+
+	std::sort(freeSlots_.begin(), freeSlots_.end(), std::greater<uint32_t>());
+
+	for (const auto probe : candidates)
+	{
+		if (!IsResident(probe))
+		{
+			slots_[probe] = freeSlots_.back();
+			freeSlots_.pop_back();
+			changes.push_back({ probe, slots_[probe], true });
+		}
+	}
+
+	return changes;
+}
+
+void LightProbeResidency::StorePage(const uint32_t probe, std::vector<uint8_t>&& page)
+{
+	DiscardPage(probe);
+	pageBytes_ += page.size();
+	pages_[probe] = std::move(page);
+}
+
+std::vector<uint8_t> LightProbeResidency::TakePage(const uint32_t probe)
+{
+	pageBytes_ -= pages_[probe].size();
+	return std::move(pages_[probe]);
+}
+
+void LightProbeResidency::DiscardPage(const uint32_t probe)
+{
+	pageBytes_ -= pages_[probe].size();
+	pages_[probe].clear();
+	pages_[probe].shrink_to_fit();
+}
+
+}
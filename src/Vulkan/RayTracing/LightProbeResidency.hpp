@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Vulkan::RayTracing
+{
+	// A probe entering or leaving the atlas slot it is resident in.
+	struct ProbeResidencyChange
+	{
+		uint32_t Probe;
+		uint32_t Slot;
+		bool IsPagedIn;
+	};
+
+	// Keeps a fixed number of light probes resident in the probe atlas (one slot = one atlas layer and its SH coefficients).
+	// The slot of each probe is the indirection table read by the shaders. The other probes are paged out: their baked data,
+	// if any, waits in host memory until they become resident again, otherwise they have to be baked once paged in.
+	// The resident probes are the ones with the lowest priority values (e.g. the distance to the camera).
+	class LightProbeResidency final
+	{
+	public:
+
+		static constexpr uint32_t NotResident = 0xFFFFFFFF; // ProbeNotResident in LightProbe.glsl
+
+		LightProbeResidency(uint32_t probeCount, uint32_t slotCount);
+		~LightProbeResidency() = default;
+
+		uint32_t ProbeCount() const { return static_cast<uint32_t>(slots_.size()); }
+		uint32_t SlotCount() const { return slotCount_; }
+		bool IsComplete() const { return slotCount_ == ProbeCount(); }
+
+		const std::vector<uint32_t>& Slots() const { return slots_; }
+		uint32_t Slot(uint32_t probe) const { return slots_[probe]; }
+		bool IsResident(uint32_t probe) const { return slots_[probe] != NotResident; }
+
+		// Picks the probes to keep resident, given one priority per probe (lower first, infinity = never resident).
+		// Returns the probes paged out first, so that their data can be saved before their slot is reused.
+		std::vector<ProbeResidencyChange> Update(const std::vector<float>& priorities);
+
+		// Host copies of the baked data of the paged out probes.
+		bool HasPage(uint32_t probe) const { return !pages_[probe].empty(); }
+		void StorePage(uint32_t probe, std::vector<uint8_t>&& page);
+		std::vector<uint8_t> TakePage(uint32_t probe);
+		void DiscardPage(uint32_t probe);
+		uint64_t PageBytes() const { return pageBytes_; }
+
+	private:
+
+		// A resident probe is only paged out for a probe this much more important, so that the residency does not oscillate
+		// between probes at about the same distance.
+		static constexpr float ResidentBias = 0.8f;
+
+		const uint32_t slotCount_;
+		std::vector<uint32_t> slots_;
+		std::vector<uint32_t> freeSlots_;
+		std::vector<std::vector<uint8_t>> pages_;
+		uint64_t pageBytes_{};
+	};
+
+}
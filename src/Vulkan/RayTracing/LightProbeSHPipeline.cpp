@@ -0,0 +1,111 @@
+#include "LightProbeSHPipeline.hpp"
+#include "LightProbeAtlas.hpp"
+#include "Utilities/Exception.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/DescriptorBinding.hpp"
+#include "Vulkan/DescriptorSetManager.hpp"
+#include "Vulkan/DescriptorSets.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/Sampler.hpp"
+#include "Vulkan/ShaderModule.hpp"
+
+namespace Vulkan::RayTracing {
+
+	LightProbeSHPipeline::LightProbeSHPipeline(
+		const Device& device,
+		const LightProbeConfig& lightProbeConfig,
+		const LightProbeAtlas& lightProbeAtlas,
+		const std::unique_ptr<Buffer>& lightProbePosBuffer,
+		const std::unique_ptr<Buffer>& lightProbeSHBuffer) :
+		device_(device)
+	{
+		// Create descriptor pool/sets.
+		const std::vector<DescriptorBinding> descriptorBindings =
+		{
+			// Light probe positions
+			{0, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe radiance atlas
+			{1, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe SH coefficients
+			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}
+		};
+
+		descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, 1));
+
+		auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+		VkDescriptorBufferInfo lightProbePosBufferInfo = {};
+		lightProbePosBufferInfo.buffer = lightProbePosBuffer->Handle();
+		lightProbePosBufferInfo.range = VK_WHOLE_SIZE;
+
+		VkDescriptorImageInfo radianceInfo = {};
+		radianceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		radianceInfo.imageView = lightProbeAtlas.Radiance().probeImageView->Handle();
+		radianceInfo.sampler = lightProbeAtlas.Radiance().Sampler().Handle();
+
+		VkDescriptorBufferInfo lightProbeSHBufferInfo = {};
+		lightProbeSHBufferInfo.buffer = lightProbeSHBuffer->Handle();
+		lightProbeSHBufferInfo.range = VK_WHOLE_SIZE;
+
+		const std::vector<VkWriteDescriptorSet> descriptorWrites =
+		{
+			descriptorSets.Bind(0, 0, lightProbePosBufferInfo),
+			descriptorSets.Bind(0, 1, radianceInfo),
+			descriptorSets.Bind(0, 2, lightProbeSHBufferInfo)
+		};
+
+		descriptorSets.UpdateDescriptors(0, descriptorWrites);
+
+		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), VK_SHADER_STAGE_COMPUTE_BIT));
+
+		// Load shaders, specialised on the probe resolution.
+		const ShaderModule computeShader(device, "../assets/shaders/LightProbeSH.comp.spv");
+
+		const uint32_t specializationData[] = { lightProbeConfig.RadianceResolution };
+		const VkSpecializationMapEntry specializationEntries[] =
+		{
+			{0, 0, sizeof(uint32_t)}
+		};
+
+		VkSpecializationInfo specializationInfo = {};
+		specializationInfo.mapEntryCount = 1;
+		specializationInfo.pMapEntries = specializationEntries;
+		specializationInfo.dataSize = sizeof(specializationData);
+		specializationInfo.pData = specializationData;
+
+		// Create compute pipeline
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = nullptr;
+		pipelineInfo.flags = 0;
+		pipelineInfo.stage = computeShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, &specializationInfo);
+		pipelineInfo.layout = pipelineLayout_->Handle();
+		pipelineInfo.basePipelineHandle = nullptr;
+		pipelineInfo.basePipelineIndex = 0;
+
+		Check(vkCreateComputePipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+			"create light probe SH pipeline");
+	}
+
+	LightProbeSHPipeline::~LightProbeSHPipeline()
+	{
+		if (pipeline_ != nullptr)
+		{
+			vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+			pipeline_ = nullptr;
+		}
+
+		pipelineLayout_.reset();
+		descriptorSetManager_.reset();
+	}
+
+	VkDescriptorSet LightProbeSHPipeline::DescriptorSet() const
+	{
+		return descriptorSetManager_->DescriptorSets().Handle(0);
+	}
+
+}
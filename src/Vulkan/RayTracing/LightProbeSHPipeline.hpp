@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include "LightProbeConfig.hpp"
+#include <memory>
+
+namespace Vulkan
+{
+	class Buffer;
+	class DescriptorSetManager;
+	class Device;
+	class PipelineLayout;
+}
+
+namespace Vulkan::RayTracing
+{
+	class LightProbeAtlas;
+
+	// Compute pipeline projecting the baked probe radiance onto L2 spherical harmonics (see LightProbeSH.comp).
+	// Dispatch one workgroup per active probe.
+	class LightProbeSHPipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(LightProbeSHPipeline)
+
+		LightProbeSHPipeline(
+			const Device& device,
+			const LightProbeConfig& lightProbeConfig,
+			const LightProbeAtlas& lightProbeAtlas,
+			const std::unique_ptr<Buffer>& lightProbePosBuffer,
+			const std::unique_ptr<Buffer>& lightProbeSHBuffer);
+
+		~LightProbeSHPipeline();
+
+		VkDescriptorSet DescriptorSet() const;
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+
+	private:
+
+		const Device& device_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+	};
+
+}
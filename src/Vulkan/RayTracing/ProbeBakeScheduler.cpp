@@ -0,0 +1,178 @@
+#include "ProbeBakeScheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Vulkan::RayTracing {
+
+ProbeBakeScheduler::ProbeBakeScheduler(const uint32_t probeCount, const uint32_t texelsPerProbe, const uint32_t samplesPerTexel, const uint32_t maxSamplesPerTexel) :
+	probeCount_(probeCount),
+	bakeProbeCount_(probeCount),
+	texelsPerProbe_(std::max(texelsPerProbe, 1u)),
+	samplesPerTexel_(std::max(samplesPerTexel, 1u)),
+	maxSamplesPerTexel_(std::max(maxSamplesPerTexel, samplesPerTexel_))
+{
+	Reset();
+}
+
+void ProbeBakeScheduler::Reset()
+{
+	Reset(probeCount_);
+}
+
+void ProbeBakeScheduler::Reset(const uint32_t bakeProbeCount)
+{
+	bakeProbeCount_ = std::min(bakeProbeCount, probeCount_);
+	activeTexelRatio_ = 1.0f;
+	samplesDone_ = bakeProbeCount_ != 0 ? 0 : maxSamplesPerTexel_;
+	passSamples_ = 0;
+	nextProbe_ = 0;
+	raysDone_ = 0;
+	catchUpProbeCount_ = 0;
+	catchUpSamples_ = 0;
+	nextUpdateProbe_ = 0;
+	updateIndex_ = 0;
+}
+
+void ProbeBakeScheduler::Restart(const uint32_t probeCount, const uint32_t restartProbeCount, const uint32_t bakeProbeCount)
+{
+	const bool isBaking = !IsComplete();
+	const uint32_t samplesDone = samplesDone_;
+	const uint64_t raysDone = raysDone_;
+	const uint32_t previousBakeProbeCount = bakeProbeCount_;
+
+	probeCount_ = probeCount;
+	Reset(restartProbeCount);
+
+	if (!isBaking || bakeProbeCount <= bakeProbeCount_)
+	{
+		return;
+	}
+
+	// The probes still baking keep the samples of their completed passes (the interrupted pass starts over) and their share
+	// of the rays done so far.
+	const uint32_t keptProbeCount = std::min(bakeProbeCount, probeCount_) - bakeProbeCount_;
+
+	catchUpProbeCount_ = bakeProbeCount_;
+	catchUpSamples_ = catchUpProbeCount_ != 0 ? samplesDone : 0;
+	bakeProbeCount_ += keptProbeCount;
+	samplesDone_ = catchUpSamples_ != 0 ? 0 : samplesDone;
+	raysDone_ = previousBakeProbeCount != 0 ? static_cast<uint64_t>(static_cast<double>(raysDone) * keptProbeCount / previousBakeProbeCount) : 0;
+}
+
+void ProbeBakeScheduler::Complete()
+{
+	samplesDone_ = maxSamplesPerTexel_;
+	passSamples_ = 0;
+	nextProbe_ = 0;
+	raysDone_ = TotalRays();
+	catchUpProbeCount_ = 0;
+	catchUpSamples_ = 0;
+}
+
+void ProbeBakeScheduler::SetActiveTexelRatio(const float ratio)
+{
+	// At least one texel per probe, so that the probe rays never round down to nothing.
+	activeTexelRatio_ = std::clamp(ratio, 1.0f / texelsPerProbe_, 1.0f);
+}
+
+std::vector<ProbeBakeBatch> ProbeBakeScheduler::NextBatches(const uint64_t rayBudget)
+{
+	std::vector<ProbeBakeBatch> batches;
+	uint64_t budgetLeft = rayBudget;
+
+	while (!IsComplete())
+	{
+		const auto activeTexels = static_cast<uint64_t>(std::ceil(activeTexelRatio_ * texelsPerProbe_));
+		const bool isCatchUp = samplesDone_ < catchUpSamples_;
+		const uint32_t passProbeCount = PassProbeCount();
+
+		// At the start of a pass, share the budget evenly between the texels still sampled by all the probes of the pass.
+		if (nextProbe_ == 0)
+		{
+			const uint64_t totalTexels = activeTexels * passProbeCount;
+			const uint64_t raysLeft = TotalRays() - std::min(raysDone_, TotalRays());
+			const uint32_t samplesLeft = (isCatchUp ? catchUpSamples_ : maxSamplesPerTexel_) - samplesDone_;
+			const uint64_t maxPassSamples = std::min<uint64_t>(samplesLeft, (raysLeft + totalTexels - 1) / totalTexels);
+			passSamples_ = static_cast<uint32_t>(std::clamp<uint64_t>(rayBudget / totalTexels, 1, std::max<uint64_t>(maxPassSamples, 1)));
+		}
+
+		const uint64_t probeRays = activeTexels * passSamples_;
+		auto probeCount = static_cast<uint32_t>(std::min<uint64_t>(passProbeCount - nextProbe_, budgetLeft / probeRays));
+
+		// At least one probe is always baked, otherwise a budget smaller than a single probe pass would never make progress.
+		if (probeCount == 0)
+		{
+			if (!batches.empty())
+			{
+				break;
+			}
+
+			probeCount = 1;
+		}
+
+		batches.push_back({ nextProbe_, probeCount, samplesDone_, passSamples_ });
+
+		raysDone_ += probeRays * probeCount;
+		budgetLeft -= std::min(probeRays * probeCount, budgetLeft);
+		nextProbe_ += probeCount;
+
+		if (nextProbe_ == passProbeCount)
+		{
+			samplesDone_ += passSamples_;
+			nextProbe_ = 0;
+
+			// Once the average budget is spent, the texels still sampled keep the samples they have.
+			if (!isCatchUp && raysDone_ >= TotalRays())
+			{
+				samplesDone_ = maxSamplesPerTexel_;
+			}
+		}
+	}
+
+	return batches;
+}
+
+std::vector<ProbeBakeBatch> ProbeBakeScheduler::NextUpdateBatches(const uint32_t probeCount, const uint32_t samplesPerTexel)
+{
+	std::vector<ProbeBakeBatch> batches;
+
+	if (!IsComplete() || probeCount == 0 || samplesPerTexel == 0)
+	{
+		return batches;
+	}
+
+	// The update window wraps around the end of the probe range, which splits it into two batches.
+	uint32_t probesLeft = std::min(probeCount, probeCount_);
+
+	while (probesLeft != 0)
+	{
+		const uint32_t count = std::min(probesLeft, probeCount_ - nextUpdateProbe_);
+
+		batches.push_back({ nextUpdateProbe_, count, updateIndex_, samplesPerTexel });
+
+		probesLeft -= count;
+		nextUpdateProbe_ = (nextUpdateProbe_ + count) % probeCount_;
+	}
+
+	++updateIndex_;
+
+	return batches;
+}
+
+float ProbeBakeScheduler::Progress() const
+{
+	const uint64_t totalRays = TotalRays();
+	return totalRays != 0 && !IsComplete() ? std::min(static_cast<float>(static_cast<double>(raysDone_) / totalRays), 1.0f) : 1.0f;
+}
+
+uint64_t ProbeBakeScheduler::TotalRays() const
+{
+	return static_cast<uint64_t>(bakeProbeCount_) * texelsPerProbe_ * samplesPerTexel_;
+}
+
+uint32_t ProbeBakeScheduler::PassProbeCount() const
+{
+	return samplesDone_ < catchUpSamples_ ? catchUpProbeCount_ : bakeProbeCount_;
+}
+
+}
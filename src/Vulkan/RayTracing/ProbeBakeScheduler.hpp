@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Vulkan::RayTracing
+{
+	// A single bake dispatch: accumulate SampleCount more samples per texel into ProbeCount consecutive probes,
+	// all of which have already accumulated SampleOffset samples. For update batches, SampleOffset is the update index
+	// and only seeds the random rays.
+	struct ProbeBakeBatch
+	{
+		uint32_t FirstProbe;
+		uint32_t ProbeCount;
+		uint32_t SampleOffset;
+		uint32_t SampleCount;
+	};
+
+	// Spreads the light probe bake over many frames. Each frame gets a ray budget (probes x texels x samples).
+	// The probes are refined in passes, every probe receiving the same number of samples in a pass, so that consecutive
+	// probes can be baked by a single dispatch and all of them converge at the same pace.
+	// With adaptive sampling, the converged texels stop tracing rays: the budget is then shared between the texels still
+	// sampled (see SetActiveTexelRatio), and the passes go on until the average budget of samplesPerTexel rays per texel is
+	// spent, the noisiest texels receiving up to maxSamplesPerTexel samples.
+	// Once the bake is complete, the probes can be relit incrementally: each frame updates the next few probes
+	// of a rotating window, so that dynamic lighting has a bounded per-frame cost.
+	class ProbeBakeScheduler final
+	{
+	public:
+
+		ProbeBakeScheduler(uint32_t probeCount, uint32_t texelsPerProbe, uint32_t samplesPerTexel, uint32_t maxSamplesPerTexel = 0);
+		~ProbeBakeScheduler() = default;
+
+		void Reset();
+		void Complete();
+
+		// Restarts the bake of the first probes only, the other ones being already baked (e.g. when probe cascades scroll).
+		void Reset(uint32_t bakeProbeCount);
+
+		// The probe list changed during the bake (e.g. when probe cascades scroll): the first restartProbeCount probes are
+		// baked from scratch, and catch up with the samples of the next ones up to bakeProbeCount, whose bake goes on.
+		// The remaining probes are already baked. Once complete, behaves as Reset(restartProbeCount).
+		void Restart(uint32_t probeCount, uint32_t restartProbeCount, uint32_t bakeProbeCount);
+
+		// Fraction of the texels of the last baked probes that have not converged yet (as counted by the bake raygen).
+		void SetActiveTexelRatio(float ratio);
+
+		std::vector<ProbeBakeBatch> NextBatches(uint64_t rayBudget);
+		std::vector<ProbeBakeBatch> NextUpdateBatches(uint32_t probeCount, uint32_t samplesPerTexel);
+
+		bool IsComplete() const { return samplesDone_ == maxSamplesPerTexel_; }
+		float Progress() const;
+
+		uint32_t ProbeCount() const { return probeCount_; }
+		uint32_t BakeProbeCount() const { return bakeProbeCount_; }
+		uint32_t SamplesPerTexel() const { return samplesPerTexel_; }
+
+		// Probe rays of the bake so far (one per texel sample, the bounces not included).
+		uint64_t RaysDone() const { return raysDone_; }
+
+	private:
+
+		uint64_t TotalRays() const;
+		uint32_t PassProbeCount() const;
+
+		uint32_t probeCount_;
+		uint32_t bakeProbeCount_;
+		const uint32_t texelsPerProbe_;
+		const uint32_t samplesPerTexel_;
+		const uint32_t maxSamplesPerTexel_;
+
+		float activeTexelRatio_{ 1.0f };
+		uint32_t samplesDone_{};
+		uint32_t passSamples_{};
+		uint32_t nextProbe_{};
+		uint64_t raysDone_{};
+
+		// Restarted probes baked on their own until they have as many samples as the other ones (see Restart).
+		uint32_t catchUpProbeCount_{};
+		uint32_t catchUpSamples_{};
+
+		uint32_t nextUpdateProbe_{};
+		uint32_t updateIndex_{};
+	};
+
+}
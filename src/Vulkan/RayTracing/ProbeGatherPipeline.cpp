@@ -0,0 +1,189 @@
+#include "ProbeGatherPipeline.hpp"
+#include "LightProbeAtlas.hpp"
+#include "Assets/UniformBuffer.hpp"
+#include "Utilities/Exception.hpp"
+#include "Vulkan/Buffer.hpp"
+#include "Vulkan/Device.hpp"
+#include "Vulkan/DescriptorBinding.hpp"
+#include "Vulkan/DescriptorSetManager.hpp"
+#include "Vulkan/DescriptorSets.hpp"
+#include "Vulkan/ImageView.hpp"
+#include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/Sampler.hpp"
+#include "Vulkan/ShaderModule.hpp"
+
+namespace Vulkan::RayTracing {
+
+	ProbeGatherPipeline::ProbeGatherPipeline(
+		const Device& device,
+		const std::vector<Assets::UniformBuffer>& uniformBuffers,
+		const ImageView& outputImageView,
+		const ImageView& gBufferDepthImageView,
+		const ImageView& gBufferNormalImageView,
+		const ImageView& gBufferAlbedoImageView,
+		const LightProbeAtlas& lightProbeAtlas,
+		const std::unique_ptr<Buffer>& lightProbeGridBuffer,
+		const std::unique_ptr<Buffer>& lightProbeStateBuffer,
+		const std::unique_ptr<Buffer>& lightProbeOffsetBuffer,
+		const std::unique_ptr<Buffer>& lightProbeSHBuffer,
+		const std::unique_ptr<Buffer>& lightProbeSlotBuffer) :
+		device_(device)
+	{
+		// Create descriptor pool/sets.
+		const std::vector<DescriptorBinding> descriptorBindings =
+		{
+			// Output image
+			{0, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Camera information & co
+			{1, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// G-buffer depth, normal and albedo
+			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+			{3, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+			{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe grid
+			{5, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe radiance, distance moments and glossy radiance atlases
+			{6, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{7, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{8, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{9, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe states, SH irradiance, offsets and atlas slots
+			{10, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{12, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT},
+			{13, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT}
+		};
+
+		descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+
+		auto& descriptorSets = descriptorSetManager_->DescriptorSets();
+
+		for (uint32_t i = 0; i != uniformBuffers.size(); ++i)
+		{
+			// Output image and G-buffer
+			VkDescriptorImageInfo outputImageInfo = {};
+			outputImageInfo.imageView = outputImageView.Handle();
+			outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo gBufferDepthInfo = {};
+			gBufferDepthInfo.imageView = gBufferDepthImageView.Handle();
+			gBufferDepthInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo gBufferNormalInfo = {};
+			gBufferNormalInfo.imageView = gBufferNormalImageView.Handle();
+			gBufferNormalInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo gBufferAlbedoInfo = {};
+			gBufferAlbedoInfo.imageView = gBufferAlbedoImageView.Handle();
+			gBufferAlbedoInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			// Uniform buffer
+			VkDescriptorBufferInfo uniformBufferInfo = {};
+			uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
+			uniformBufferInfo.range = VK_WHOLE_SIZE;
+
+			// Light probe atlases
+			VkDescriptorImageInfo radianceInfo = {};
+			radianceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			radianceInfo.imageView = lightProbeAtlas.Radiance().probeImageView->Handle();
+			radianceInfo.sampler = lightProbeAtlas.Radiance().Sampler().Handle();
+
+			VkDescriptorImageInfo sphericalDistancesInfo = {};
+			sphericalDistancesInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			sphericalDistancesInfo.imageView = lightProbeAtlas.SphericalDistances().probeImageView->Handle();
+			sphericalDistancesInfo.sampler = lightProbeAtlas.SphericalDistances().Sampler().Handle();
+
+			VkDescriptorImageInfo squaredDistancesInfo = {};
+			squaredDistancesInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			squaredDistancesInfo.imageView = lightProbeAtlas.SquaredDistances().probeImageView->Handle();
+			squaredDistancesInfo.sampler = lightProbeAtlas.SquaredDistances().Sampler().Handle();
+
+			VkDescriptorImageInfo glossyInfo = {};
+			glossyInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			glossyInfo.imageView = lightProbeAtlas.Glossy().probeImageView->Handle();
+			glossyInfo.sampler = lightProbeAtlas.Glossy().Sampler().Handle();
+
+			// Light probe buffers
+			VkDescriptorBufferInfo lightProbeGridBufferInfo = {};
+			lightProbeGridBufferInfo.buffer = lightProbeGridBuffer->Handle();
+			lightProbeGridBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightProbeStateBufferInfo = {};
+			lightProbeStateBufferInfo.buffer = lightProbeStateBuffer->Handle();
+			lightProbeStateBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightProbeSHBufferInfo = {};
+			lightProbeSHBufferInfo.buffer = lightProbeSHBuffer->Handle();
+			lightProbeSHBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightProbeOffsetBufferInfo = {};
+			lightProbeOffsetBufferInfo.buffer = lightProbeOffsetBuffer->Handle();
+			lightProbeOffsetBufferInfo.range = VK_WHOLE_SIZE;
+
+			VkDescriptorBufferInfo lightProbeSlotBufferInfo = {};
+			lightProbeSlotBufferInfo.buffer = lightProbeSlotBuffer->Handle();
+			lightProbeSlotBufferInfo.range = VK_WHOLE_SIZE;
+
+			const std::vector<VkWriteDescriptorSet> descriptorWrites =
+			{
+				descriptorSets.Bind(i, 0, outputImageInfo),
+				descriptorSets.Bind(i, 1, uniformBufferInfo),
+				descriptorSets.Bind(i, 2, gBufferDepthInfo),
+				descriptorSets.Bind(i, 3, gBufferNormalInfo),
+				descriptorSets.Bind(i, 4, gBufferAlbedoInfo),
+				descriptorSets.Bind(i, 5, lightProbeGridBufferInfo),
+				descriptorSets.Bind(i, 6, radianceInfo),
+				descriptorSets.Bind(i, 7, sphericalDistancesInfo),
+				descriptorSets.Bind(i, 8, squaredDistancesInfo),
+				descriptorSets.Bind(i, 9, glossyInfo),
+				descriptorSets.Bind(i, 10, lightProbeStateBufferInfo),
+				descriptorSets.Bind(i, 11, lightProbeSHBufferInfo),
+				descriptorSets.Bind(i, 12, lightProbeOffsetBufferInfo),
+				descriptorSets.Bind(i, 13, lightProbeSlotBufferInfo)
+			};
+
+			descriptorSets.UpdateDescriptors(i, descriptorWrites);
+		}
+
+		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), VK_SHADER_STAGE_COMPUTE_BIT));
+
+		// Load shaders.
+		const ShaderModule computeShader(device, "../assets/shaders/ProbeGather.comp.spv");
+
+		// Create compute pipeline
+		VkComputePipelineCreateInfo pipelineInfo = {};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.pNext = nullptr;
+		pipelineInfo.flags = 0;
+		pipelineInfo.stage = computeShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT);
+		pipelineInfo.layout = pipelineLayout_->Handle();
+		pipelineInfo.basePipelineHandle = nullptr;
+		pipelineInfo.basePipelineIndex = 0;
+
+		Check(vkCreateComputePipelines(device.Handle(), nullptr, 1, &pipelineInfo, nullptr, &pipeline_),
+			"create probe gather pipeline");
+	}
+
+	ProbeGatherPipeline::~ProbeGatherPipeline()
+	{
+		if (pipeline_ != nullptr)
+		{
+			vkDestroyPipeline(device_.Handle(), pipeline_, nullptr);
+			pipeline_ = nullptr;
+		}
+
+		pipelineLayout_.reset();
+		descriptorSetManager_.reset();
+	}
+
+	VkDescriptorSet ProbeGatherPipeline::DescriptorSet(const uint32_t index) const
+	{
+		return descriptorSetManager_->DescriptorSets().Handle(index);
+	}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Vulkan/Vulkan.hpp"
+#include <memory>
+#include <vector>
+
+namespace Assets
+{
+	class UniformBuffer;
+}
+
+namespace Vulkan
+{
+	class Buffer;
+	class DescriptorSetManager;
+	class Device;
+	class ImageView;
+	class PipelineLayout;
+}
+
+namespace Vulkan::RayTracing
+{
+	class LightProbeAtlas;
+
+	// Compute pipeline shading the G-buffer traced by the probe-shaded raygen from the light probes (see ProbeGather.comp).
+	// Dispatch one workgroup per TileSize x TileSize pixel tile.
+	class ProbeGatherPipeline final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(ProbeGatherPipeline)
+
+		static constexpr uint32_t TileSize = 8;
+
+		ProbeGatherPipeline(
+			const Device& device,
+			const std::vector<Assets::UniformBuffer>& uniformBuffers,
+			const ImageView& outputImageView,
+			const ImageView& gBufferDepthImageView,
+			const ImageView& gBufferNormalImageView,
+			const ImageView& gBufferAlbedoImageView,
+			const LightProbeAtlas& lightProbeAtlas,
+			const std::unique_ptr<Buffer>& lightProbeGridBuffer,
+			const std::unique_ptr<Buffer>& lightProbeStateBuffer,
+			const std::unique_ptr<Buffer>& lightProbeOffsetBuffer,
+			const std::unique_ptr<Buffer>& lightProbeSHBuffer,
+			const std::unique_ptr<Buffer>& lightProbeSlotBuffer);
+
+		~ProbeGatherPipeline();
+
+		VkDescriptorSet DescriptorSet(uint32_t index) const;
+		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
+
+	private:
+
+		const Device& device_;
+
+		VULKAN_HANDLE(VkPipeline, pipeline_)
+
+		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
+		std::unique_ptr<class PipelineLayout> pipelineLayout_;
+	};
+
+}
@@ -0,0 +1,63 @@
+#include "ProbeTransfer.hpp"
+#include "Vulkan/Device.hpp"
+#include <cstring>
+
+namespace Vulkan::RayTracing {
+
+ProbeTransfer::ProbeTransfer(const Device& device) :
+	device_(device)
+{
+}
+
+ProbeTransfer::~ProbeTransfer()
+{
+	buffers_.clear();
+	bufferMemories_.clear(); // release memory after bound buffer has been destroyed
+}
+
+size_t ProbeTransfer::Download(VkCommandBuffer commandBuffer, const Buffer& srcBuffer, const VkDeviceSize size)
+{
+	const auto index = AddReadBackBuffer(size);
+
+	VkBufferCopy copyRegion = {};
+	copyRegion.size = size;
+
+	vkCmdCopyBuffer(commandBuffer, srcBuffer.Handle(), buffers_[index]->Handle(), 1, &copyRegion);
+
+	return index;
+}
+
+const Buffer& ProbeTransfer::AddUploadBuffer(const void* const data, const VkDeviceSize size)
+{
+	const auto& buffer = AddBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+	auto& memory = *bufferMemories_.back();
+
+	std::memcpy(memory.Map(0, size), data, size);
+	memory.Unmap();
+
+	return buffer;
+}
+
+size_t ProbeTransfer::AddReadBackBuffer(const VkDeviceSize size)
+{
+	AddBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+	return buffers_.size() - 1;
+}
+
+const Buffer& ProbeTransfer::AddBuffer(const VkDeviceSize size, const VkBufferUsageFlags usage)
+{
+	buffers_.emplace_back(new Buffer(device_, size, usage));
+	bufferMemories_.emplace_back(new DeviceMemory(buffers_.back()->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
+
+	return *buffers_.back();
+}
+
+void ProbeTransfer::Read(const size_t index, void* const data, const VkDeviceSize size) const
+{
+	auto& memory = *bufferMemories_[index];
+
+	std::memcpy(data, memory.Map(0, size), size);
+	memory.Unmap();
+}
+
+}
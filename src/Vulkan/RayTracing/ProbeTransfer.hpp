@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Vulkan/Buffer.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Vulkan
+{
+	class Device;
+}
+
+namespace Vulkan::RayTracing
+{
+	// Light probe uploads and read backs recorded into a frame command buffer, rather than submitted and waited for on their
+	// own (e.g. when the probe cascades scroll or the probes are paged in and out of the atlas). Owns the host-visible
+	// buffers of the copies, which must outlive the frame: the read backs are valid once the frame has completed.
+	class ProbeTransfer final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(ProbeTransfer)
+
+		explicit ProbeTransfer(const Device& device);
+		~ProbeTransfer();
+
+		// Records the copy of host data into a device buffer (created with VK_BUFFER_USAGE_TRANSFER_DST_BIT).
+		template <class T>
+		void Upload(VkCommandBuffer commandBuffer, const Buffer& dstBuffer, const std::vector<T>& content);
+
+		// Records the copy of a device buffer (created with VK_BUFFER_USAGE_TRANSFER_SRC_BIT), returns its read back index.
+		size_t Download(VkCommandBuffer commandBuffer, const Buffer& srcBuffer, VkDeviceSize size);
+
+		// Buffers for the copies recorded by the caller (e.g. of atlas layers): a staging buffer holding host data, and a
+		// buffer read back once the frame has completed.
+		const Buffer& AddUploadBuffer(const void* data, VkDeviceSize size);
+		size_t AddReadBackBuffer(VkDeviceSize size);
+		const Buffer& ReadBackBuffer(size_t index) const { return *buffers_[index]; }
+
+		// Host copy of a read back, once the frame has completed and the copies have been made available to the host.
+		template <class T>
+		std::vector<T> Read(size_t index, size_t count) const;
+
+	private:
+
+		const Buffer& AddBuffer(VkDeviceSize size, VkBufferUsageFlags usage);
+		void Read(size_t index, void* data, VkDeviceSize size) const;
+
+		const class Device& device_;
+
+		std::vector<std::unique_ptr<Buffer>> buffers_;
+		std::vector<std::unique_ptr<DeviceMemory>> bufferMemories_;
+	};
+
+	template <class T>
+	void ProbeTransfer::Upload(VkCommandBuffer commandBuffer, const Buffer& dstBuffer, const std::vector<T>& content)
+	{
+		const auto contentSize = sizeof(T) * content.size();
+		const auto& stagingBuffer = AddUploadBuffer(content.data(), contentSize);
+
+		VkBufferCopy copyRegion = {};
+		copyRegion.size = contentSize;
+
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer.Handle(), dstBuffer.Handle(), 1, &copyRegion);
+	}
+
+	template <class T>
+	std::vector<T> ProbeTransfer::Read(const size_t index, const size_t count) const
+	{
+		std::vector<T> content(count);
+		Read(index, content.data(), sizeof(T) * count);
+		return content;
+	}
+
+}
@@ -1,7 +1,7 @@
 #include "RayTracingPipeline.hpp"
 #include "DeviceProcedures.hpp"
 #include "TopLevelAccelerationStructure.hpp"
-#include "LightProbe.hpp"
+#include "LightProbeAtlas.hpp"
 #include "Assets/Scene.hpp"
 #include "Assets/UniformBuffer.hpp"
 #include "Utilities/Exception.hpp"
@@ -12,8 +12,10 @@
 #include "Vulkan/DescriptorSets.hpp"
 #include "Vulkan/ImageView.hpp"
 #include "Vulkan/PipelineLayout.hpp"
+#include "Vulkan/Sampler.hpp"
 #include "Vulkan/ShaderModule.hpp"
 #include "Vulkan/SwapChain.hpp"
+#include <array>
 
 
 namespace Vulkan::RayTracing {
@@ -24,44 +26,64 @@ namespace Vulkan::RayTracing {
 		const TopLevelAccelerationStructure& accelerationStructure,
 		const ImageView& accumulationImageView,
 		const ImageView& outputImageView,
+		const ImageView& gBufferDepthImageView,
+		const ImageView& gBufferNormalImageView,
+		const ImageView& gBufferAlbedoImageView,
+		const ImageView& historyImageView,
+		const ImageView& historyDepthImageView,
+		const ImageView& historyNormalImageView,
 		const std::vector<Assets::UniformBuffer>& uniformBuffers,
 		const Assets::Scene& scene,
-		const std::vector<LightProbe>& lightProbes,
-		const std::unique_ptr<Buffer>& lightProbePosBuffer) :
+		const LightProbeAtlas& lightProbeAtlas,
+		const std::unique_ptr<Buffer>& lightProbeSlotBuffer,
+		const bool rayQuery) :
 		swapChain_(swapChain)
 	{
-		// Create descriptor pool/sets.
+		// Create descriptor pool/sets, shared with the ray query compute pipelines (where the whole trace happens).
 		const auto& device = swapChain.Device();
 		const std::vector<DescriptorBinding> descriptorBindings =
 		{
 			// Top level acceleration structure.
-			{0, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+			{0, 1, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Image accumulation & output
-			{1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
-			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+			{1, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{2, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Camera information & co
-			{3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR},
+			{3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Vertex buffer, Index buffer, Material buffer, Offset buffer
-			{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{6, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-			{7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
+			{4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{6, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Textures and image samplers
-			{8, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR},
-
-			//Light probes positions
-			{9, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,VK_SHADER_STAGE_RAYGEN_BIT_KHR },
+			{8, static_cast<uint32_t>(scene.TextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 			// Light probe textures
-			{10, static_cast<uint32_t>(lightProbes.size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR},
+			{10, 1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
 
 
 			// The Procedural buffer.
-			{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR}
+			{11, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Light probe atlas slots (indirection table of the resident probes)
+			{18, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Emissive triangles (next-event estimation)
+			{19, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// G-buffer depth, normal and albedo (probe-shaded mode)
+			{20, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{21, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{22, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+
+			// Previous frame accumulation, depth and normal (temporal reprojection)
+			{23, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{24, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT},
+			{25, 1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT}
 		};
 
 		descriptorSetManager_.reset(new DescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
@@ -79,21 +101,16 @@ namespace Vulkan::RayTracing {
 			structureInfo.pAccelerationStructures = &accelerationStructureHandle;
 
 
-			std::vector<VkDescriptorImageInfo> radianceInfo(lightProbes.size());
-
-			for (uint32_t a = 0; a < lightProbes.size(); a++)
-			{
-				auto& rInfo = radianceInfo[a];
-
-				rInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-				rInfo.imageView = lightProbes[a].radianceDistribution->probeImageView->Handle();
-				rInfo.sampler = (lightProbes[a].radianceDistribution->Sampler().Handle());
-			}
-
+			// Light probe radiance atlas
+			VkDescriptorImageInfo radianceInfo = {};
+			radianceInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			radianceInfo.imageView = lightProbeAtlas.Radiance().probeImageView->Handle();
+			radianceInfo.sampler = lightProbeAtlas.Radiance().Sampler().Handle();
 
-			VkDescriptorBufferInfo lightProbePosBufferInfo = {};
-			lightProbePosBufferInfo.buffer = lightProbePosBuffer->Handle();
-			lightProbePosBufferInfo.range = VK_WHOLE_SIZE;
+			// Light probe atlas slots
+			VkDescriptorBufferInfo lightProbeSlotBufferInfo = {};
+			lightProbeSlotBufferInfo.buffer = lightProbeSlotBuffer->Handle();
+			lightProbeSlotBufferInfo.range = VK_WHOLE_SIZE;
 
 			// Accumulation image
 			VkDescriptorImageInfo accumulationImageInfo = {};
@@ -105,6 +122,32 @@ namespace Vulkan::RayTracing {
 			outputImageInfo.imageView = outputImageView.Handle();
 			outputImageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 
+			// G-buffer
+			VkDescriptorImageInfo gBufferDepthInfo = {};
+			gBufferDepthInfo.imageView = gBufferDepthImageView.Handle();
+			gBufferDepthInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo gBufferNormalInfo = {};
+			gBufferNormalInfo.imageView = gBufferNormalImageView.Handle();
+			gBufferNormalInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo gBufferAlbedoInfo = {};
+			gBufferAlbedoInfo.imageView = gBufferAlbedoImageView.Handle();
+			gBufferAlbedoInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			// Previous frame history
+			VkDescriptorImageInfo historyInfo = {};
+			historyInfo.imageView = historyImageView.Handle();
+			historyInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo historyDepthInfo = {};
+			historyDepthInfo.imageView = historyDepthImageView.Handle();
+			historyDepthInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			VkDescriptorImageInfo historyNormalInfo = {};
+			historyNormalInfo.imageView = historyNormalImageView.Handle();
+			historyNormalInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
 			// Uniform buffer
 			VkDescriptorBufferInfo uniformBufferInfo = {};
 			uniformBufferInfo.buffer = uniformBuffers[i].Buffer().Handle();
@@ -130,6 +173,11 @@ namespace Vulkan::RayTracing {
 			offsetsBufferInfo.buffer = scene.OffsetsBuffer().Handle();
 			offsetsBufferInfo.range = VK_WHOLE_SIZE;
 
+			// Emitter buffer
+			VkDescriptorBufferInfo emitterBufferInfo = {};
+			emitterBufferInfo.buffer = scene.EmitterBuffer().Handle();
+			emitterBufferInfo.range = VK_WHOLE_SIZE;
+
 			// Image and texture samplers.
 			std::vector<VkDescriptorImageInfo> imageInfos(scene.TextureSamplers().size());
 
@@ -152,8 +200,15 @@ namespace Vulkan::RayTracing {
 				descriptorSets.Bind(i, 6, materialBufferInfo),
 				descriptorSets.Bind(i, 7, offsetsBufferInfo),
 				descriptorSets.Bind(i, 8, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size())),
-				descriptorSets.Bind(i, 9, lightProbePosBufferInfo),
-				descriptorSets.Bind(i, 10, *radianceInfo.data(),static_cast<uint32_t>(radianceInfo.size()))
+				descriptorSets.Bind(i, 10, radianceInfo),
+				descriptorSets.Bind(i, 18, lightProbeSlotBufferInfo),
+				descriptorSets.Bind(i, 19, emitterBufferInfo),
+				descriptorSets.Bind(i, 20, gBufferDepthInfo),
+				descriptorSets.Bind(i, 21, gBufferNormalInfo),
+				descriptorSets.Bind(i, 22, gBufferAlbedoInfo),
+				descriptorSets.Bind(i, 23, historyInfo),
+				descriptorSets.Bind(i, 24, historyDepthInfo),
+				descriptorSets.Bind(i, 25, historyNormalInfo)
 			};
 
 			// Procedural buffer (optional)
@@ -170,7 +225,7 @@ namespace Vulkan::RayTracing {
 			descriptorSets.UpdateDescriptors(i, descriptorWrites);
 		}
 
-		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout()));
+		pipelineLayout_.reset(new class PipelineLayout(device, descriptorSetManager_->DescriptorSetLayout(), VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_COMPUTE_BIT));
 
 		// Load shaders.
 		const ShaderModule rayGenShader(device, "../assets/shaders/RayTracing.rgen.spv");
@@ -179,63 +234,79 @@ namespace Vulkan::RayTracing {
 		const ShaderModule proceduralClosestHitShader(device, "../assets/shaders/RayTracing.Procedural.rchit.spv");
 		const ShaderModule proceduralIntersectionShader(device, "../assets/shaders/RayTracing.Procedural.rint.spv");
 
-		std::vector<VkPipelineShaderStageCreateInfo> shaderStages =
+		// One raygen stage per render mode, specialised from the same shader module.
+		const VkSpecializationMapEntry renderModeEntry = { 0, 0, sizeof(uint32_t) };
+		std::array<uint32_t, RenderModeCount> renderModes = {};
+		std::array<VkSpecializationInfo, RenderModeCount> renderModeInfos = {};
+		std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+
+		for (uint32_t mode = 0; mode != RenderModeCount; ++mode)
 		{
-			rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR),
-			missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR),
-			closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-			proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR),
-			proceduralIntersectionShader.CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR)
-		};
+			renderModes[mode] = mode;
+			renderModeInfos[mode].mapEntryCount = 1;
+			renderModeInfos[mode].pMapEntries = &renderModeEntry;
+			renderModeInfos[mode].dataSize = sizeof(uint32_t);
+			renderModeInfos[mode].pData = &renderModes[mode];
+
+			shaderStages.push_back(rayGenShader.CreateShaderStage(VK_SHADER_STAGE_RAYGEN_BIT_KHR, &renderModeInfos[mode]));
+		}
+
+		shaderStages.push_back(missShader.CreateShaderStage(VK_SHADER_STAGE_MISS_BIT_KHR));
+		shaderStages.push_back(closestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR));
+		shaderStages.push_back(proceduralClosestHitShader.CreateShaderStage(VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR));
+		shaderStages.push_back(proceduralIntersectionShader.CreateShaderStage(VK_SHADER_STAGE_INTERSECTION_BIT_KHR));
 
 		// Shader groups
-		VkRayTracingShaderGroupCreateInfoKHR rayGenGroupInfo = {};
-		rayGenGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
-		rayGenGroupInfo.pNext = nullptr;
-		rayGenGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-		rayGenGroupInfo.generalShader = 0;
-		rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
-		rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-		rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
+		std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups;
 		rayGenIndex_ = 0;
 
+		for (uint32_t mode = 0; mode != RenderModeCount; ++mode)
+		{
+			VkRayTracingShaderGroupCreateInfoKHR rayGenGroupInfo = {};
+			rayGenGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
+			rayGenGroupInfo.pNext = nullptr;
+			rayGenGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
+			rayGenGroupInfo.generalShader = mode;
+			rayGenGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
+			rayGenGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
+			rayGenGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
+
+			groups.push_back(rayGenGroupInfo);
+		}
+
 		VkRayTracingShaderGroupCreateInfoKHR missGroupInfo = {};
 		missGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
 		missGroupInfo.pNext = nullptr;
 		missGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_GENERAL_KHR;
-		missGroupInfo.generalShader = 1;
+		missGroupInfo.generalShader = RenderModeCount;
 		missGroupInfo.closestHitShader = VK_SHADER_UNUSED_KHR;
 		missGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
 		missGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-		missIndex_ = 1;
+		missIndex_ = RenderModeCount;
 
 		VkRayTracingShaderGroupCreateInfoKHR triangleHitGroupInfo = {};
 		triangleHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
 		triangleHitGroupInfo.pNext = nullptr;
 		triangleHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_TRIANGLES_HIT_GROUP_KHR;
 		triangleHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-		triangleHitGroupInfo.closestHitShader = 2;
+		triangleHitGroupInfo.closestHitShader = RenderModeCount + 1;
 		triangleHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
 		triangleHitGroupInfo.intersectionShader = VK_SHADER_UNUSED_KHR;
-		triangleHitGroupIndex_ = 2;
+		triangleHitGroupIndex_ = RenderModeCount + 1;
 
 		VkRayTracingShaderGroupCreateInfoKHR proceduralHitGroupInfo = {};
 		proceduralHitGroupInfo.sType = VK_STRUCTURE_TYPE_RAY_TRACING_SHADER_GROUP_CREATE_INFO_KHR;
 		proceduralHitGroupInfo.pNext = nullptr;
 		proceduralHitGroupInfo.type = VK_RAY_TRACING_SHADER_GROUP_TYPE_PROCEDURAL_HIT_GROUP_KHR;
 		proceduralHitGroupInfo.generalShader = VK_SHADER_UNUSED_KHR;
-		proceduralHitGroupInfo.closestHitShader = 3;
+		proceduralHitGroupInfo.closestHitShader = RenderModeCount + 2;
 		proceduralHitGroupInfo.anyHitShader = VK_SHADER_UNUSED_KHR;
-		proceduralHitGroupInfo.intersectionShader = 4;
-		proceduralHitGroupIndex_ = 3;
+		proceduralHitGroupInfo.intersectionShader = RenderModeCount + 3;
+		proceduralHitGroupIndex_ = RenderModeCount + 2;
 
-		std::vector<VkRayTracingShaderGroupCreateInfoKHR> groups =
-		{
-			rayGenGroupInfo, 
-			missGroupInfo, 
-			triangleHitGroupInfo, 
-			proceduralHitGroupInfo,
-		};
+		groups.push_back(missGroupInfo);
+		groups.push_back(triangleHitGroupInfo);
+		groups.push_back(proceduralHitGroupInfo);
 
 		// Create graphic pipeline
 		VkRayTracingPipelineCreateInfoKHR pipelineInfo = {};
@@ -253,10 +324,42 @@ namespace Vulkan::RayTracing {
 
 		Check(deviceProcedures.vkCreateRayTracingPipelinesKHR(device.Handle(), nullptr, nullptr, 1, &pipelineInfo, nullptr, &pipeline_), 
 			"create ray tracing pipeline");
+
+		// Inline ray query backend: the same render modes traced from compute shaders, without shader binding table.
+		if (!rayQuery)
+		{
+			return;
+		}
+
+		const ShaderModule rayQueryShader(device, "../assets/shaders/RayQuery.comp.spv");
+
+		for (uint32_t mode = 0; mode != RenderModeCount; ++mode)
+		{
+			VkComputePipelineCreateInfo computePipelineInfo = {};
+			computePipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+			computePipelineInfo.pNext = nullptr;
+			computePipelineInfo.flags = 0;
+			computePipelineInfo.stage = rayQueryShader.CreateShaderStage(VK_SHADER_STAGE_COMPUTE_BIT, &renderModeInfos[mode]);
+			computePipelineInfo.layout = pipelineLayout_->Handle();
+			computePipelineInfo.basePipelineHandle = nullptr;
+			computePipelineInfo.basePipelineIndex = 0;
+
+			Check(vkCreateComputePipelines(device.Handle(), nullptr, 1, &computePipelineInfo, nullptr, &computePipelines_[mode]),
+				"create ray query pipeline");
+		}
 	}
 
 	RayTracingPipeline::~RayTracingPipeline()
 	{
+		for (auto& computePipeline : computePipelines_)
+		{
+			if (computePipeline != nullptr)
+			{
+				vkDestroyPipeline(swapChain_.Device().Handle(), computePipeline, nullptr);
+				computePipeline = nullptr;
+			}
+		}
+
 		if (pipeline_ != nullptr)
 		{
 			vkDestroyPipeline(swapChain_.Device().Handle(), pipeline_, nullptr);
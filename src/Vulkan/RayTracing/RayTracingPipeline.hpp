@@ -1,9 +1,10 @@
 #pragma once
 
 #include "Vulkan/Vulkan.hpp"
+#include <array>
 #include <memory>
 #include <vector>
-#include "LightProbe.hpp"
+#include "LightProbeAtlas.hpp"
 #include "Vulkan/Buffer.hpp"
 
 namespace Assets
@@ -25,6 +26,16 @@ namespace Vulkan::RayTracing
 	class DeviceProcedures;
 	class TopLevelAccelerationStructure;
 
+	// The main raygen is specialised for each render mode (RenderMode in RayTracing.rgen), every variant being a raygen
+	// record of its own in the shader binding table. The probe-shaded raygen only traces the G-buffer, shaded by ProbeGatherPipeline.
+	// Each mode also has an inline ray query compute pipeline (RayQuery.comp), sharing the layout and descriptor sets.
+	enum class RenderMode : uint32_t
+	{
+		PathTraced,
+		ProbeShaded,
+		ProbeTexture
+	};
+
 	class RayTracingPipeline final
 	{
 	public:
@@ -37,19 +48,32 @@ namespace Vulkan::RayTracing
 			const TopLevelAccelerationStructure& accelerationStructure,
 			const ImageView& accumulationImageView,
 			const ImageView& outputImageView,
+			const ImageView& gBufferDepthImageView,
+			const ImageView& gBufferNormalImageView,
+			const ImageView& gBufferAlbedoImageView,
+			const ImageView& historyImageView,
+			const ImageView& historyDepthImageView,
+			const ImageView& historyNormalImageView,
 			const std::vector<Assets::UniformBuffer>& uniformBuffers,
 			const Assets::Scene& scene,
-			const std::vector<LightProbe>& lightProbes,
-			const std::unique_ptr<Buffer>& lightProbePosBuffer);
+			const LightProbeAtlas& lightProbeAtlas,
+			const std::unique_ptr<Buffer>& lightProbeSlotBuffer,
+			bool rayQuery);
 
 
 		~RayTracingPipeline();
 
-		uint32_t RayGenShaderIndex() const { return rayGenIndex_; }
+		static constexpr uint32_t RenderModeCount = 3;
+
+		uint32_t RayGenShaderIndex(RenderMode mode) const { return rayGenIndex_ + static_cast<uint32_t>(mode); }
 		uint32_t MissShaderIndex() const { return missIndex_; }
 		uint32_t TriangleHitGroupIndex() const { return triangleHitGroupIndex_; }
 		uint32_t ProceduralHitGroupIndex() const { return proceduralHitGroupIndex_; }
 
+		// Dispatched over 8x8 pixel tiles. Only created if the device supports ray queries.
+		VkPipeline ComputePipelineHandle(RenderMode mode) const { return computePipelines_[static_cast<uint32_t>(mode)]; }
+		static constexpr uint32_t ComputeTileSize = 8;
+
 		VkDescriptorSet DescriptorSet(uint32_t index) const;
 		const class PipelineLayout& PipelineLayout() const { return *pipelineLayout_; }
 
@@ -59,6 +83,8 @@ namespace Vulkan::RayTracing
 
 		VULKAN_HANDLE(VkPipeline, pipeline_)
 
+		std::array<VkPipeline, RenderModeCount> computePipelines_{};
+
 		std::unique_ptr<DescriptorSetManager> descriptorSetManager_;
 		std::unique_ptr<class PipelineLayout> pipelineLayout_;
 
@@ -66,63 +66,30 @@ ShaderBindingTable::ShaderBindingTable(
 	const std::vector<Entry>& rayGenPrograms,
 	const std::vector<Entry>& missPrograms, 
 	const std::vector<Entry>& hitGroups) :
-	
-	rayGenEntrySize_(GetEntrySize(rayTracingProperties, rayGenPrograms)),
-	missEntrySize_(GetEntrySize(rayTracingProperties, missPrograms)),
-	hitGroupEntrySize_(GetEntrySize(rayTracingProperties, hitGroups)),
-	
-	rayGenOffset_(0),
-	missOffset_(rayGenPrograms.size() * rayGenEntrySize_),
-	hitGroupOffset_(missOffset_ + missPrograms.size() * missEntrySize_),
-
-	rayGenSize_(rayGenPrograms.size() * rayGenEntrySize_),
-	missSize_(missPrograms.size() * missEntrySize_),
-	hitGroupSize_(hitGroups.size() * hitGroupEntrySize_)
+	ShaderBindingTable(deviceProcedures, rayTracingPipeline.Handle(), rayTracingProperties, rayGenPrograms, missPrograms, hitGroups)
 {
-	// Compute the size of the table.
-	const size_t sbtSize =
-		rayGenPrograms.size() * rayGenEntrySize_ +
-		missPrograms.size() * missEntrySize_ +
-		hitGroups.size() * hitGroupEntrySize_;
-
-	// Allocate buffer & memory.
-	const auto& device = rayTracingProperties.Device();
-
-	buffer_.reset(new class Buffer(device, sbtSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR));
-	bufferMemory_.reset(new DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)));
-
-	// Generate the table.
-	const uint32_t handleSize = rayTracingProperties.ShaderGroupHandleSize();
-	const size_t groupCount = rayGenPrograms.size() + missPrograms.size() + hitGroups.size();
-	std::vector<uint8_t> shaderHandleStorage(groupCount * handleSize);
-
-	Check(deviceProcedures.vkGetRayTracingShaderGroupHandlesKHR(
-		device.Handle(), 
-		rayTracingPipeline.Handle(), 
-		0, static_cast<uint32_t>(groupCount),
-		shaderHandleStorage.size(),
-		shaderHandleStorage.data()), 
-		"get ray tracing shader group handles");
-
-	// Copy the shader identifiers followed by their resource pointers or root constants: 
-	// first the ray generation, then the miss shaders, and finally the set of hit groups.
-	auto* pData = static_cast<uint8_t*>(bufferMemory_->Map(0, sbtSize));
-
-	pData += CopyShaderData(pData, rayTracingProperties, rayGenPrograms, rayGenEntrySize_, shaderHandleStorage.data());
-	pData += CopyShaderData(pData, rayTracingProperties, missPrograms, missEntrySize_, shaderHandleStorage.data());
-	         CopyShaderData(pData, rayTracingProperties, hitGroups, hitGroupEntrySize_, shaderHandleStorage.data());
-
-	bufferMemory_->Unmap();
 }
 
 ShaderBindingTable::ShaderBindingTable(const DeviceProcedures& deviceProcedures, 
 	const LightProbeRTPipeline& rayTracingPipeline, const RayTracingProperties& rayTracingProperties, 
 	const std::vector<Entry>& rayGenPrograms, const std::vector<Entry>& missPrograms, const std::vector<Entry>& hitGroups) :
+	ShaderBindingTable(deviceProcedures, rayTracingPipeline.Handle(), rayTracingProperties, rayGenPrograms, missPrograms, hitGroups, VK_SHARING_MODE_CONCURRENT)
+{
+}
 
+ShaderBindingTable::ShaderBindingTable(
+	const DeviceProcedures& deviceProcedures, 
+	const VkPipeline pipeline,
+	const RayTracingProperties& rayTracingProperties,
+	const std::vector<Entry>& rayGenPrograms,
+	const std::vector<Entry>& missPrograms, 
+	const std::vector<Entry>& hitGroups,
+	const VkSharingMode sharingMode) :
+	
 	rayGenEntrySize_(GetEntrySize(rayTracingProperties, rayGenPrograms)),
 	missEntrySize_(GetEntrySize(rayTracingProperties, missPrograms)),
 	hitGroupEntrySize_(GetEntrySize(rayTracingProperties, hitGroups)),
-
+	
 	rayGenOffset_(0),
 	missOffset_(rayGenPrograms.size() * rayGenEntrySize_),
 	hitGroupOffset_(missOffset_ + missPrograms.size() * missEntrySize_),
@@ -130,9 +97,7 @@ ShaderBindingTable::ShaderBindingTable(const DeviceProcedures& deviceProcedures,
 	rayGenSize_(rayGenPrograms.size() * rayGenEntrySize_),
 	missSize_(missPrograms.size() * missEntrySize_),
 	hitGroupSize_(hitGroups.size() * hitGroupEntrySize_)
-
 {
-
 	// Compute the size of the table.
 	const size_t sbtSize =
 		rayGenPrograms.size() * rayGenEntrySize_ +
@@ -142,7 +107,7 @@ ShaderBindingTable::ShaderBindingTable(const DeviceProcedures& deviceProcedures,
 	// Allocate buffer & memory.
 	const auto& device = rayTracingProperties.Device();
 
-	buffer_.reset(new class Buffer(device, sbtSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR));
+	buffer_.reset(new class Buffer(device, sbtSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_SHADER_BINDING_TABLE_BIT_KHR, sharingMode));
 	bufferMemory_.reset(new DeviceMemory(buffer_->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)));
 
 	// Generate the table.
@@ -151,11 +116,11 @@ ShaderBindingTable::ShaderBindingTable(const DeviceProcedures& deviceProcedures,
 	std::vector<uint8_t> shaderHandleStorage(groupCount * handleSize);
 
 	Check(deviceProcedures.vkGetRayTracingShaderGroupHandlesKHR(
-		device.Handle(),
-		rayTracingPipeline.Handle(),
+		device.Handle(), 
+		pipeline, 
 		0, static_cast<uint32_t>(groupCount),
 		shaderHandleStorage.size(),
-		shaderHandleStorage.data()),
+		shaderHandleStorage.data()), 
 		"get ray tracing shader group handles");
 
 	// Copy the shader identifiers followed by their resource pointers or root constants: 
@@ -164,7 +129,7 @@ ShaderBindingTable::ShaderBindingTable(const DeviceProcedures& deviceProcedures,
 
 	pData += CopyShaderData(pData, rayTracingProperties, rayGenPrograms, rayGenEntrySize_, shaderHandleStorage.data());
 	pData += CopyShaderData(pData, rayTracingProperties, missPrograms, missEntrySize_, shaderHandleStorage.data());
-	CopyShaderData(pData, rayTracingProperties, hitGroups, hitGroupEntrySize_, shaderHandleStorage.data());
+	         CopyShaderData(pData, rayTracingProperties, hitGroups, hitGroupEntrySize_, shaderHandleStorage.data());
 
 	bufferMemory_->Unmap();
 }
@@ -32,6 +32,16 @@ namespace Vulkan::RayTracing
 
 		VULKAN_NON_COPIABLE(ShaderBindingTable)
 
+		// Shader groups of any ray tracing pipeline, the overloads below take the pipeline objects of this application.
+		ShaderBindingTable(
+			const DeviceProcedures& deviceProcedures,
+			VkPipeline pipeline,
+			const RayTracingProperties& rayTracingProperties,
+			const std::vector<Entry>& rayGenPrograms,
+			const std::vector<Entry>& missPrograms,
+			const std::vector<Entry>& hitGroups,
+			VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE);
+
 		ShaderBindingTable(
 			const DeviceProcedures& deviceProcedures,
 			const RayTracingPipeline& rayTracingPipeline,
@@ -41,6 +51,7 @@ namespace Vulkan::RayTracing
 			const std::vector<Entry>& hitGroups);
 
 
+		// The light probe bake traces on the compute queue, its table is shared with it.
 		ShaderBindingTable(
 			const DeviceProcedures& deviceProcedures,
 			const LightProbeRTPipeline& rayTracingPipeline,
@@ -0,0 +1,53 @@
+#include "TimelineSemaphore.hpp"
+#include "Device.hpp"
+
+namespace Vulkan {
+
+TimelineSemaphore::TimelineSemaphore(const class Device& device, const uint64_t initialValue) :
+	device_(device)
+{
+	VkSemaphoreTypeCreateInfo typeInfo = {};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = initialValue;
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	Check(vkCreateSemaphore(device.Handle(), &semaphoreInfo, nullptr, &semaphore_),
+		"create timeline semaphore");
+}
+
+TimelineSemaphore::~TimelineSemaphore()
+{
+	if (semaphore_ != nullptr)
+	{
+		vkDestroySemaphore(device_.Handle(), semaphore_, nullptr);
+		semaphore_ = nullptr;
+	}
+}
+
+uint64_t TimelineSemaphore::CounterValue() const
+{
+	uint64_t value = 0;
+
+	Check(vkGetSemaphoreCounterValue(device_.Handle(), semaphore_, &value),
+		"get semaphore counter value");
+
+	return value;
+}
+
+void TimelineSemaphore::Wait(const uint64_t value, const uint64_t timeout) const
+{
+	VkSemaphoreWaitInfo waitInfo = {};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore_;
+	waitInfo.pValues = &value;
+
+	Check(vkWaitSemaphores(device_.Handle(), &waitInfo, timeout),
+		"wait for timeline semaphore");
+}
+
+}
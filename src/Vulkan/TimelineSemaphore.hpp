@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Vulkan.hpp"
+
+namespace Vulkan
+{
+	class Device;
+
+	// Semaphore with a monotonically increasing 64-bit counter, which both queues and the host can wait for.
+	class TimelineSemaphore final
+	{
+	public:
+
+		VULKAN_NON_COPIABLE(TimelineSemaphore)
+
+		TimelineSemaphore(const Device& device, uint64_t initialValue);
+		~TimelineSemaphore();
+
+		const class Device& Device() const { return device_; }
+
+		uint64_t CounterValue() const;
+		void Wait(uint64_t value, uint64_t timeout) const;
+
+	private:
+
+		const class Device& device_;
+
+		VULKAN_HANDLE(VkSemaphore, semaphore_)
+	};
+
+}
@@ -13,5 +13,6 @@ namespace Vulkan
 		bool CursorDisabled;
 		bool Fullscreen;
 		bool Resizable;
+		bool Headless; // No window nor swapchain, e.g. to bake the light probes offline.
 	};
 }
@@ -36,7 +36,8 @@ int main(int argc, const char* argv[]) noexcept
 			options.Height,
 			options.Benchmark && options.Fullscreen,
 			options.Fullscreen,
-			!options.Fullscreen
+			!options.Fullscreen,
+			options.BakeProbes
 		};
 
 		RayTracer application(userSettings, windowConfig, static_cast<VkPresentModeKHR>(options.PresentMode));
@@ -48,6 +49,12 @@ int main(int argc, const char* argv[]) noexcept
 
 		SetVulkanDevice(application, options.VisibleDevices);
 
+		if (options.BakeProbes)
+		{
+			application.BakeProbes();
+			return EXIT_SUCCESS;
+		}
+
 		PrintVulkanSwapChainInformation(application, options.Benchmark);
 
 		application.Run();
@@ -104,6 +111,24 @@ namespace
 		userSettings.NumberOfSamples = options.Samples;
 		userSettings.NumberOfBounces = options.Bounces;
 		userSettings.MaxNumberOfSamples = options.MaxSamples;
+		userSettings.RayQuery = options.RayQuery;
+		userSettings.TemporalAccumulation = options.Temporal;
+		userSettings.TemporalMaxHistory = options.TemporalMaxHistory;
+		userSettings.ProbeBakeBudget = options.ProbeBakeBudget;
+		userSettings.ProbeResolution = options.ProbeResolution;
+		userSettings.ProbeDepthResolution = options.ProbeDepthResolution;
+		userSettings.ProbeFormat = options.ProbeFormat;
+		userSettings.ProbeSamples = options.ProbeSamples;
+		userSettings.ProbeAdaptiveThreshold = options.ProbeAdaptiveThreshold;
+		userSettings.ProbeSpacing = options.ProbeSpacing;
+		userSettings.ProbeMaxCount = options.ProbeMaxCount;
+		userSettings.ProbeCascades = options.ProbeCascades;
+		userSettings.ProbeCascadeResolution = options.ProbeCascadeResolution;
+		userSettings.ProbeResidentCount = options.ProbeResidentCount;
+		userSettings.ProbeCacheDirectory = options.ProbeCacheDirectory;
+		userSettings.ProbeUpdateCount = options.ProbeUpdateCount;
+		userSettings.ProbeUpdateSamples = options.ProbeUpdateSamples;
+		userSettings.ProbeHysteresis = options.ProbeHysteresis;
 
 		userSettings.ShowSettings = !options.Benchmark;
 		userSettings.ShowOverlay = true;
@@ -113,6 +138,8 @@ namespace
 
 		userSettings.ShowLightProbeTexture = false;
 		userSettings.ShowOriginalRaytrace = false;
+		userSettings.ProbeSHShading = false;
+		userSettings.RasterisedPrimary = false;
 
 		return userSettings;
 	}
@@ -235,7 +262,7 @@ namespace
 				return false;
 			}
 
-			// We want a device that supports the ray tracing extension.
+			// We want a device that supports the ray tracing extension (inline ray queries are optional, see --ray-query).
 			const auto extensions = Vulkan::GetEnumerateVector(device, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties);
 			const auto hasRayTracing = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension)
 			{